@@ -41,10 +41,54 @@
 #include <QDir>
 #include <QFileInfo>
 #include <QPointer>
+#include <QStorageInfo>
+#include <QThread>
 #include <QTimer>
 
+/**
+ * @return An identifier of the rotational disk @p path is stored on,
+ *         or an empty string if the disk is not rotational or unknown.
+ */
+static QString rotationalDisk(const QString &path)
+{
+#ifdef Q_OS_LINUX
+    const QStorageInfo storage(path);
+    if (!storage.isValid()) {
+        return QString();
+    }
+
+    const QString device = QFileInfo(QFile::decodeName(storage.device())).canonicalFilePath();
+    if (device.isEmpty()) {
+        return QString();
+    }
+
+    QString disk = QFileInfo(QStringLiteral("/sys/class/block/") + QFileInfo(device).fileName()).canonicalFilePath();
+    if (disk.isEmpty()) {
+        return QString();
+    }
+
+    // Partitions have no queue of their own, use the one of their disk.
+    if (QFileInfo::exists(disk + QStringLiteral("/partition"))) {
+        disk = QFileInfo(disk).path();
+    }
+
+    QFile rotational(disk + QStringLiteral("/queue/rotational"));
+    if (rotational.open(QIODevice::ReadOnly) && rotational.read(1) == "1") {
+        return disk;
+    }
+#else
+    Q_UNUSED(path)
+#endif
+
+    return QString();
+}
+
 BatchExtract::BatchExtract(QObject* parent)
     : KCompositeJob(parent),
+      m_initialJobCount(0),
+      m_finishedJobCount(0),
+      m_failedJobCount(0),
+      m_maxConcurrentJobs(qMax(1, QThread::idealThreadCount())),
       m_autoSubfolder(false),
       m_preservePaths(true),
       m_openDestinationAfterExtraction(false),
@@ -71,6 +115,7 @@ void BatchExtract::addExtraction(const QUrl& url)
     qCDebug(ARK) << QString(QStringLiteral("Registering job from archive %1, to %2, preservePaths %3")).arg(url.toLocalFile(), destination, QString::number(preservePaths()));
 
     addSubjob(job);
+    m_pendingJobs.append(job);
 
     m_fileNames[job] = qMakePair(url.toLocalFile(), destination);
 
@@ -86,7 +131,22 @@ bool BatchExtract::doKill()
         return false;
     }
 
-    return subjobs().first()->kill();
+    m_pendingJobs.clear();
+
+    // The subjobs are killed quietly, KJob::kill() emits our own result.
+    bool killed = true;
+    foreach (KJob *job, m_runningJobs.keys()) {
+        killed = job->kill(KJob::Quietly) && killed;
+        removeSubjob(job);
+    }
+    m_runningJobs.clear();
+
+    foreach (KJob *job, subjobs()) {
+        removeSubjob(job);
+        job->deleteLater();
+    }
+
+    return killed;
 }
 
 void BatchExtract::slotUserQuery(Kerfuffle::Query *query)
@@ -123,17 +183,62 @@ void BatchExtract::slotStartJob()
     KIO::getJobTracker()->registerJob(this);
     m_registered = true;
 
-    emit description(this,
-                     i18n("Extracting Files"),
-                     qMakePair(i18n("Source archive"), m_fileNames.value(subjobs().at(0)).first),
-                     qMakePair(i18n("Destination"), m_fileNames.value(subjobs().at(0)).second)
-                    );
-
     m_initialJobCount = subjobs().size();
 
-    qCDebug(ARK) << "Starting first job";
+    // All the archives are extracted to the same folder.
+    const QString destinationDisk = rotationalDisk(destinationFolder());
+    foreach (KJob *job, subjobs()) {
+        QStringList disks;
+        const QString sourceDisk = rotationalDisk(m_fileNames.value(job).first);
+        if (!sourceDisk.isEmpty()) {
+            disks << sourceDisk;
+        }
+        if (!destinationDisk.isEmpty() && destinationDisk != sourceDisk) {
+            disks << destinationDisk;
+        }
+        m_jobDisks.insert(job, disks);
+    }
+
+    qCDebug(ARK) << "Starting up to" << m_maxConcurrentJobs << "jobs";
+
+    startPendingJobs();
+}
+
+void BatchExtract::startPendingJobs()
+{
+    auto it = m_pendingJobs.begin();
+    while (it != m_pendingJobs.end() && m_runningJobs.size() < m_maxConcurrentJobs) {
+        KJob *job = *it;
+        if (!canStartJob(job)) {
+            ++it;
+            continue;
+        }
+
+        it = m_pendingJobs.erase(it);
+        m_runningJobs.insert(job, 0);
+
+        emit description(this,
+                         i18n("Extracting Files"),
+                         qMakePair(i18n("Source archive"), m_fileNames.value(job).first),
+                         qMakePair(i18n("Destination"), m_fileNames.value(job).second)
+                        );
+
+        qCDebug(ARK) << "Starting job for" << m_fileNames.value(job).first;
+        job->start();
+    }
+}
+
+bool BatchExtract::canStartJob(KJob *job) const
+{
+    foreach (const QString &disk, m_jobDisks.value(job)) {
+        for (auto it = m_runningJobs.constBegin(); it != m_runningJobs.constEnd(); ++it) {
+            if (m_jobDisks.value(it.key()).contains(disk)) {
+                return false;
+            }
+        }
+    }
 
-    subjobs().at(0)->start();
+    return true;
 }
 
 void BatchExtract::showFailedFiles()
@@ -145,29 +250,39 @@ void BatchExtract::showFailedFiles()
 
 void BatchExtract::slotResult(KJob *job)
 {
-    // TODO: The user must be informed about which file caused the error, and that the other files
-    //       in the queue will not be extracted.
+    removeSubjob(job);
+    m_runningJobs.remove(job);
+    m_finishedJobCount++;
+
+    if (job->error() == KJob::KilledJobError) {
+        // The user canceled the extraction of this archive, stop the whole batch.
+        qCDebug(ARK) << "Job killed, stopping the remaining ones";
+        setError(KJob::KilledJobError);
+        doKill();
+        emitResult();
+        return;
+    }
+
     if (job->error()) {
         qCDebug(ARK) << "There was en error:" << job->error() << ", errorText:" << job->errorString();
 
-        setErrorText(job->errorString());
-        setError(job->error());
-
-        removeSubjob(job);
-
-        if (job->error() != KJob::KilledJobError) {
-            KMessageBox::error(nullptr, job->errorString().isEmpty() ?
-                                     i18n("There was an error during extraction.") : job->errorString());
-        }
-
-        emitResult();
-        return;
+        // Keep extracting the other archives, the failed ones are listed at the end.
+        const QString fileName = QFileInfo(m_fileNames.value(job).first).fileName();
+        m_failedFiles.append(job->errorString().isEmpty() ?
+                             fileName :
+                             i18nc("@item:inlistbox archive name: error message", "%1: %2", fileName, job->errorString()));
+        m_failedJobCount++;
     }
 
-    removeSubjob(job);
+    updatePercent();
 
     if (!hasSubjobs()) {
-        if (openDestinationAfterExtraction()) {
+        if (m_failedJobCount > 0) {
+            setError(KJob::UserDefinedError);
+            setErrorText(i18np("One archive could not be extracted.",
+                               "%1 archives could not be extracted.",
+                               m_failedJobCount));
+        } else if (openDestinationAfterExtraction()) {
             QUrl destination(destinationFolder());
             destination.setPath(QDir::cleanPath(destination.path()));
             KRun::runUrl(destination, QStringLiteral("inode/directory"), nullptr, KRun::RunExecutables, QString(), QByteArray());
@@ -176,22 +291,31 @@ void BatchExtract::slotResult(KJob *job)
         qCDebug(ARK) << "Finished, emitting the result";
         emitResult();
     } else {
-        qCDebug(ARK) << "Starting the next job";
-        emit description(this,
-                         i18n("Extracting Files"),
-                         qMakePair(i18n("Source archive"), m_fileNames.value(subjobs().at(0)).first),
-                         qMakePair(i18n("Destination"), m_fileNames.value(subjobs().at(0)).second)
-                        );
-        subjobs().at(0)->start();
+        startPendingJobs();
     }
 }
 
 void BatchExtract::forwardProgress(KJob *job, unsigned long percent)
 {
-    Q_UNUSED(job)
-    auto jobPart = static_cast<ulong>(100 / m_initialJobCount);
-    auto remainingJobs = static_cast<ulong>(m_initialJobCount - subjobs().size());
-    setPercent(jobPart * remainingJobs + percent / static_cast<ulong>(m_initialJobCount));
+    if (m_runningJobs.contains(job)) {
+        m_runningJobs[job] = percent;
+        updatePercent();
+    }
+}
+
+void BatchExtract::updatePercent()
+{
+    if (m_initialJobCount == 0) {
+        return;
+    }
+
+    // Finished jobs count as complete, whether they succeeded or not.
+    unsigned long total = 100 * static_cast<unsigned long>(m_finishedJobCount);
+    foreach (unsigned long percent, m_runningJobs) {
+        total += percent;
+    }
+
+    setPercent(total / static_cast<unsigned long>(m_initialJobCount));
 }
 
 void BatchExtract::addInput(const QUrl& url)
@@ -242,6 +366,16 @@ void BatchExtract::setPreservePaths(bool value)
     m_preservePaths = value;
 }
 
+int BatchExtract::maxConcurrentJobs() const
+{
+    return m_maxConcurrentJobs;
+}
+
+void BatchExtract::setMaxConcurrentJobs(int value)
+{
+    m_maxConcurrentJobs = qMax(1, value);
+}
+
 bool BatchExtract::showExtractDialog()
 {
     QPointer<Kerfuffle::ExtractionDialog> dialog =
@@ -31,6 +31,7 @@
 
 #include <KCompositeJob>
 
+#include <QHash>
 #include <QMap>
 #include <QVector>
 
@@ -181,6 +182,24 @@ public:
      */
     void setPreservePaths(bool value);
 
+    /**
+     * Returns the maximum number of archives that are extracted at the same time.
+     *
+     * The default value is the number of processor cores.
+     */
+    int maxConcurrentJobs() const;
+
+    /**
+     * Sets how many archives can be extracted at the same time.
+     *
+     * Whatever this value is, archives read from or extracted to the same
+     * rotational disk are never extracted at the same time, to avoid seeking
+     * back and forth between them.
+     *
+     * @param value The maximum number of jobs, at least 1.
+     */
+    void setMaxConcurrentJobs(int value);
+
 private slots:
     /**
      * Updates the percentage of the job that has been completed.
@@ -194,9 +213,9 @@ private slots:
     void showFailedFiles();
 
     /**
-     * Shows an error message if the current job hasn't finished
-     * successfully, and advances to the next extraction job if
-     * there are more.
+     * Records the archive as failed if @p job hasn't finished
+     * successfully, and starts the next extraction jobs if there
+     * are more. A failed archive does not stop the other ones.
      */
     void slotResult(KJob *job) override;
 
@@ -208,14 +227,34 @@ private slots:
     /**
      * Does the real work for start() and extracts all scheduled files.
      *
-     * Each extraction job is started after the last one finishes.
-     * The jobs are executed in the order they were added via addInput().
+     * Up to maxConcurrentJobs() extraction jobs run at the same time. The
+     * jobs are started in the order they were added via addInput().
      */
     void slotStartJob();
 
 private:
+    /**
+     * Starts the pending jobs that can run, up to maxConcurrentJobs().
+     */
+    void startPendingJobs();
+
+    /**
+     * @return Whether @p job uses none of the rotational disks used by the running jobs.
+     */
+    bool canStartJob(KJob *job) const;
+
+    void updatePercent();
+
     int m_initialJobCount;
+    int m_finishedJobCount;
+    int m_failedJobCount;
+    int m_maxConcurrentJobs;
     QMap<KJob*, QPair<QString, QString> > m_fileNames;
+    QList<KJob*> m_pendingJobs;
+    // The percentage of the running jobs.
+    QHash<KJob*, unsigned long> m_runningJobs;
+    // The rotational disks each job reads from or writes to.
+    QHash<KJob*, QStringList> m_jobDisks;
     bool m_autoSubfolder;
 
     QVector<QUrl> m_inputs;
@@ -186,9 +186,17 @@ int main(int argc, char **argv)
                                         i18n("Automatically choose a filename, with the selected suffix (for example rar, tar.gz, zip or any other supported types)"),
                                         QStringLiteral("suffix")));
 
+    parser.addOption(QCommandLineOption(QStringList() << QStringLiteral("threads"),
+                                        i18n("Number of threads used to compress the archive, for the formats supporting it (tar.gz and tar.xz)."),
+                                        QStringLiteral("number")));
+
     parser.addOption(QCommandLineOption(QStringList() << QStringLiteral("b") << QStringLiteral("batch"),
                                         i18n("Use the batch interface instead of the usual dialog. This option is implied if more than one url is specified.")));
 
+    parser.addOption(QCommandLineOption(QStringList() << QStringLiteral("j") << QStringLiteral("jobs"),
+                                        i18n("Maximum number of archives to extract at the same time in batch mode. Defaults to the number of processor cores."),
+                                        QStringLiteral("number")));
+
     parser.addOption(QCommandLineOption(QStringList() << QStringLiteral("e") << QStringLiteral("autodestination"),
                                         i18n("The destination argument will be set to the path of the first file supplied.")));
 
@@ -247,6 +255,11 @@ int main(int argc, char **argv)
                 addToArchiveJob->setAutoFilenameSuffix(parser.value(QStringLiteral("autofilename")));
             }
 
+            if (parser.isSet(QStringLiteral("threads"))) {
+                qCDebug(ARK) << "Setting compression threads to" << parser.value(QStringLiteral("threads"));
+                addToArchiveJob->setNumberOfThreads(parser.value(QStringLiteral("threads")).toInt());
+            }
+
             for (int i = 0; i < urls.count(); ++i) {
                 //TODO: use the returned value here?
                 qCDebug(ARK) << "Adding url" << QUrl::fromUserInput(urls.at(i), QString(), QUrl::AssumeLocalFile);
@@ -294,6 +307,11 @@ int main(int argc, char **argv)
                 batchJob->setOpenDestinationAfterExtraction(true);
             }
 
+            if (parser.isSet(QStringLiteral("jobs"))) {
+                qCDebug(ARK) << "Setting maximum concurrent jobs to" << parser.value(QStringLiteral("jobs"));
+                batchJob->setMaxConcurrentJobs(parser.value(QStringLiteral("jobs")).toInt());
+            }
+
             if (parser.isSet(QStringLiteral("dialog"))) {
                 qCDebug(ARK) << "Opening extraction dialog";
                 if (!batchJob->showExtractDialog()) {
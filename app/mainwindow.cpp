@@ -323,6 +323,9 @@ void MainWindow::newArchive()
         if (!dialog.data()->compressionMethod().isEmpty()) {
             m_openArgs.metaData()[QStringLiteral("compressionMethod")] = dialog.data()->compressionMethod();
         }
+        if (dialog.data()->numberOfThreads() > 0) {
+            m_openArgs.metaData()[QStringLiteral("numberOfThreads")] = QString::number(dialog.data()->numberOfThreads());
+        }
         if (!dialog.data()->encryptionMethod().isEmpty()) {
             m_openArgs.metaData()[QStringLiteral("encryptionMethod")] = dialog.data()->encryptionMethod();
         }
@@ -339,6 +342,7 @@ void MainWindow::newArchive()
         m_openArgs.metaData().remove(QStringLiteral("createNewArchive"));
         m_openArgs.metaData().remove(QStringLiteral("fixedMimeType"));
         m_openArgs.metaData().remove(QStringLiteral("compressionLevel"));
+        m_openArgs.metaData().remove(QStringLiteral("numberOfThreads"));
         m_openArgs.metaData().remove(QStringLiteral("encryptionPassword"));
         m_openArgs.metaData().remove(QStringLiteral("encryptHeader"));
     }
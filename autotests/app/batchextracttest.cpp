@@ -35,6 +35,8 @@ class BatchExtractTest : public QObject
 private Q_SLOTS:
     void testBatchExtraction_data();
     void testBatchExtraction();
+    void testConcurrentBatchExtraction_data();
+    void testConcurrentBatchExtraction();
 };
 
 QTEST_MAIN(BatchExtractTest)
@@ -117,4 +119,61 @@ void BatchExtractTest::testBatchExtraction()
     QCOMPARE(extractedEntriesCount, expectedExtractedEntriesCount);
 }
 
+void BatchExtractTest::testConcurrentBatchExtraction_data()
+{
+    QTest::addColumn<int>("maxConcurrentJobs");
+
+    QTest::newRow("one job at a time") << 1;
+    QTest::newRow("two jobs at a time") << 2;
+    QTest::newRow("more jobs than archives") << 8;
+}
+
+void BatchExtractTest::testConcurrentBatchExtraction()
+{
+    auto batchJob = new BatchExtract(this);
+
+    batchJob->addInput(QUrl::fromUserInput(QFINDTESTDATA("data/simple%archive.tar.gz")));
+    batchJob->addInput(QUrl::fromUserInput(QFINDTESTDATA("../kerfuffle/data/one_toplevel_folder.zip")));
+    batchJob->addInput(QUrl::fromUserInput(QFINDTESTDATA("../kerfuffle/data/simplearchive.tar.gz")));
+    batchJob->addInput(QUrl::fromUserInput(QFINDTESTDATA("data/test.txt.gz")));
+    batchJob->setAutoSubfolder(true);
+
+    QFETCH(int, maxConcurrentJobs);
+    batchJob->setMaxConcurrentJobs(maxConcurrentJobs);
+    QCOMPARE(batchJob->maxConcurrentJobs(), maxConcurrentJobs);
+
+    QTemporaryDir destDir;
+    if (!destDir.isValid()) {
+        QSKIP("Could not create a temporary directory for extraction. Skipping test.", SkipSingle);
+    }
+
+    batchJob->setDestinationFolder(destDir.path());
+
+    // The job is deleted once it has emitted its result.
+    int error = -1;
+    unsigned long percent = 0;
+    connect(batchJob, &KJob::result, this, [&](KJob *job) {
+        error = job->error();
+        percent = job->percent();
+    });
+
+    QEventLoop eventLoop(this);
+    connect(batchJob, &KJob::result, &eventLoop, &QEventLoop::quit);
+    batchJob->start();
+    eventLoop.exec(); // krazy:exclude=crashy
+
+    QCOMPARE(error, static_cast<int>(KJob::NoError));
+    QCOMPARE(percent, 100ul);
+
+    // Same entries as in testBatchExtraction(), each archive in its own subfolder.
+    int extractedEntriesCount = 0;
+    QDirIterator dirIt(destDir.path(), QDir::AllEntries | QDir::Hidden | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+    while (dirIt.hasNext()) {
+        extractedEntriesCount++;
+        dirIt.next();
+    }
+
+    QCOMPARE(extractedEntriesCount, 5 + 9 + 5 + 2);
+}
+
 #include "batchextracttest.moc"
@@ -30,6 +30,7 @@
 
 #include <QMimeDatabase>
 #include <QStandardPaths>
+#include <QTemporaryDir>
 #include <QTest>
 
 using namespace Kerfuffle;
@@ -43,6 +44,13 @@ private Q_SLOTS:
     void init();
     void testCompressHere_data();
     void testCompressHere();
+    void testCompressHereWithOptions_data();
+    void testCompressHereWithOptions();
+    void testAddToExistingArchive_data();
+    void testAddToExistingArchive();
+
+private:
+    bool isZstdAvailable() const;
 };
 
 void AddToArchiveTest::init()
@@ -97,6 +105,17 @@ void AddToArchiveTest::testCompressHere_data()
         << QStringLiteral("data.tar.gz")
         << 4ULL;
 
+    if (isZstdAvailable()) {
+        QTest::newRow("compress here (as TAR.ZST) - dir with subdirs")
+            << QStringLiteral("tar.zst")
+            << Archive::Unencrypted
+            << QStringList {QFINDTESTDATA("data/testdirwithsubdirs")}
+            << QStringLiteral("testdirwithsubdirs.tar.zst")
+            << 8ULL;
+    } else {
+        qDebug() << "tar.zst format not available. Skipping compress-here-(TAR.ZST) tests.";
+    }
+
     QTest::newRow("compress here (as TAR) - bug #362690")
         << QStringLiteral("tar.gz")
         << Archive::Unencrypted
@@ -252,6 +271,157 @@ void AddToArchiveTest::testCompressHere()
     archive->deleteLater();
 }
 
+void AddToArchiveTest::testCompressHereWithOptions_data()
+{
+    QTest::addColumn<QString>("expectedSuffix");
+    QTest::addColumn<int>("numberOfThreads");
+    QTest::addColumn<QString>("compressionMethod");
+    QTest::addColumn<QString>("expectedArchiveName");
+    QTest::addColumn<qulonglong>("expectedNumberOfEntries");
+
+    QTest::newRow("compress here (as TAR) - dir with subdirs, with several threads")
+        << QStringLiteral("tar.gz")
+        << 4
+        << QString()
+        << QStringLiteral("testdirwithsubdirs.tar.gz")
+        << 8ULL;
+
+    QTest::newRow("compress here (as TAR.XZ) - dir with subdirs, with several threads")
+        << QStringLiteral("tar.xz")
+        << 4
+        << QString()
+        << QStringLiteral("testdirwithsubdirs.tar.xz")
+        << 8ULL;
+
+    if (isZstdAvailable()) {
+        QTest::newRow("compress here (as TAR.ZST) - dir with subdirs, with several threads")
+            << QStringLiteral("tar.zst")
+            << 4
+            << QString()
+            << QStringLiteral("testdirwithsubdirs.tar.zst")
+            << 8ULL;
+
+        QTest::newRow("compress here (as TAR.ZST) - dir with subdirs, with long distance matching")
+            << QStringLiteral("tar.zst")
+            << 0
+            << QStringLiteral("Zstandard Long")
+            << QStringLiteral("testdirwithsubdirs.tar.zst")
+            << 8ULL;
+    } else {
+        qDebug() << "tar.zst format not available. Skipping compress-here-(TAR.ZST) tests.";
+    }
+
+    if (!PluginManager().preferredWritePluginsFor(QMimeDatabase().mimeTypeForName(QStringLiteral("application/zip"))).isEmpty()) {
+        QTest::newRow("compress here (as ZIP) - dir with subdirs, with several threads")
+            << QStringLiteral("zip")
+            << 4
+            << QString()
+            << QStringLiteral("testdirwithsubdirs.zip")
+            << 8ULL;
+    } else {
+        qDebug() << "7z/zip executable not found in path. Skipping compress-here-(ZIP) tests.";
+    }
+}
+
+void AddToArchiveTest::testCompressHereWithOptions()
+{
+    AddToArchive *addToArchiveJob = new AddToArchive(this);
+    addToArchiveJob->setChangeToFirstPath(true);
+
+    QFETCH(QString, expectedSuffix);
+    addToArchiveJob->setAutoFilenameSuffix(expectedSuffix);
+
+    QFETCH(int, numberOfThreads);
+    if (numberOfThreads > 0) {
+        addToArchiveJob->setNumberOfThreads(numberOfThreads);
+    }
+
+    QFETCH(QString, compressionMethod);
+    if (!compressionMethod.isEmpty()) {
+        addToArchiveJob->setCompressionMethod(compressionMethod);
+    }
+
+    addToArchiveJob->addInput(QUrl::fromUserInput(QFINDTESTDATA("data/testdirwithsubdirs")));
+
+    TestHelper::startAndWaitForResult(addToArchiveJob);
+
+    QFETCH(QString, expectedArchiveName);
+    auto loadJob = Archive::load(QFINDTESTDATA(QStringLiteral("data/%1").arg(expectedArchiveName)));
+    QVERIFY(loadJob);
+    loadJob->setAutoDelete(false);
+
+    TestHelper::startAndWaitForResult(loadJob);
+    auto archive = loadJob->archive();
+
+    QVERIFY(archive);
+    QVERIFY(archive->isValid());
+
+    QFETCH(qulonglong, expectedNumberOfEntries);
+    QCOMPARE(archive->numberOfEntries(), expectedNumberOfEntries);
+
+    QVERIFY(QFile(archive->fileName()).remove());
+
+    loadJob->deleteLater();
+    archive->deleteLater();
+}
+
+void AddToArchiveTest::testAddToExistingArchive_data()
+{
+    QTest::addColumn<QString>("archiveName");
+    QTest::addColumn<qulonglong>("expectedNumberOfEntries");
+
+    QTest::newRow("add to TAR.GZ - file, then dir with files")
+        << QStringLiteral("existing.tar.gz")
+        << 4ULL;
+
+    if (isZstdAvailable()) {
+        QTest::newRow("add to TAR.ZST - file, then dir with files")
+            << QStringLiteral("existing.tar.zst")
+            << 4ULL;
+    } else {
+        qDebug() << "tar.zst format not available. Skipping add-to-(TAR.ZST) tests.";
+    }
+}
+
+void AddToArchiveTest::testAddToExistingArchive()
+{
+    QTemporaryDir temporaryDir;
+    QFETCH(QString, archiveName);
+    const QUrl archiveUrl = QUrl::fromLocalFile(temporaryDir.path() + QLatin1Char('/') + archiveName);
+
+    // Create the archive, then add more files to it.
+    const QStringList inputFiles {QFINDTESTDATA("data/testfile.txt"), QFINDTESTDATA("data/testdir")};
+    foreach (const QString &file, inputFiles) {
+        AddToArchive *addToArchiveJob = new AddToArchive(this);
+        addToArchiveJob->setChangeToFirstPath(true);
+        addToArchiveJob->setFilename(archiveUrl);
+        addToArchiveJob->addInput(QUrl::fromUserInput(file));
+        TestHelper::startAndWaitForResult(addToArchiveJob);
+    }
+
+    auto loadJob = Archive::load(archiveUrl.toLocalFile());
+    QVERIFY(loadJob);
+    loadJob->setAutoDelete(false);
+
+    TestHelper::startAndWaitForResult(loadJob);
+    auto archive = loadJob->archive();
+
+    QVERIFY(archive);
+    QVERIFY(archive->isValid());
+
+    QFETCH(qulonglong, expectedNumberOfEntries);
+    QCOMPARE(archive->numberOfEntries(), expectedNumberOfEntries);
+
+    loadJob->deleteLater();
+    archive->deleteLater();
+}
+
+bool AddToArchiveTest::isZstdAvailable() const
+{
+    // The format is only available if libarchive supports zstd.
+    return PluginManager().supportedMimeTypes().contains(QStringLiteral("application/x-zstd-compressed-tar"));
+}
+
 QTEST_MAIN(AddToArchiveTest)
 
 #include "addtoarchivetest.moc"
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2026 The Ark developers <kde-utils-devel@kde.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES ( INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION ) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * ( INCLUDING NEGLIGENCE OR OTHERWISE ) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "archiveentry.h"
+
+#include <QTest>
+
+using namespace Kerfuffle;
+
+class ArchiveEntryTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testName_data();
+    void testName();
+    void testFind_data();
+    void testFind();
+    void testFindDuplicatedNames();
+    void testFindAfterChanges();
+    void testRow();
+
+private:
+    Archive::Entry *createDirectory(int children);
+};
+
+QTEST_GUILESS_MAIN(ArchiveEntryTest)
+
+Archive::Entry *ArchiveEntryTest::createDirectory(int children)
+{
+    auto dir = new Archive::Entry(this, QStringLiteral("dir/"));
+    dir->setProperty("isDirectory", true);
+    for (int i = 0; i < children; ++i) {
+        auto entry = new Archive::Entry(dir, QStringLiteral("dir/file%1.txt").arg(i));
+        dir->appendEntry(entry);
+    }
+    return dir;
+}
+
+void ArchiveEntryTest::testName_data()
+{
+    QTest::addColumn<QString>("fullPath");
+    QTest::addColumn<QString>("expectedName");
+
+    QTest::newRow("file") << QStringLiteral("a/b/file.txt") << QStringLiteral("file.txt");
+    QTest::newRow("top-level file") << QStringLiteral("file.txt") << QStringLiteral("file.txt");
+    QTest::newRow("directory") << QStringLiteral("a/b/") << QStringLiteral("b");
+    QTest::newRow("repeated slashes") << QStringLiteral("a//b//") << QStringLiteral("b");
+    QTest::newRow("root") << QStringLiteral("/") << QString();
+}
+
+void ArchiveEntryTest::testName()
+{
+    QFETCH(QString, fullPath);
+    QFETCH(QString, expectedName);
+
+    Archive::Entry entry(nullptr, fullPath);
+    QCOMPARE(entry.name(), expectedName);
+}
+
+void ArchiveEntryTest::testFind_data()
+{
+    QTest::addColumn<int>("children");
+
+    // Below and above the size from which directories index their children.
+    QTest::newRow("small directory") << 10;
+    QTest::newRow("large directory") << 1000;
+}
+
+void ArchiveEntryTest::testFind()
+{
+    QFETCH(int, children);
+
+    Archive::Entry *dir = createDirectory(children);
+    for (int i = 0; i < children; ++i) {
+        const QString name = QStringLiteral("file%1.txt").arg(i);
+        Archive::Entry *entry = dir->find(name);
+        QVERIFY(entry);
+        QCOMPARE(entry->name(), name);
+    }
+    QVERIFY(!dir->find(QStringLiteral("missing.txt")));
+}
+
+void ArchiveEntryTest::testFindDuplicatedNames()
+{
+    Archive::Entry *dir = createDirectory(100);
+
+    // A file and a directory with the same name: find() returns the first one.
+    auto first = new Archive::Entry(dir, QStringLiteral("dir/same"));
+    dir->appendEntry(first);
+    auto second = new Archive::Entry(dir, QStringLiteral("dir/same/"));
+    second->setProperty("isDirectory", true);
+    dir->appendEntry(second);
+
+    QCOMPARE(dir->find(QStringLiteral("same")), first);
+    dir->removeEntryAt(dir->entries().indexOf(first));
+    QCOMPARE(dir->find(QStringLiteral("same")), second);
+}
+
+void ArchiveEntryTest::testFindAfterChanges()
+{
+    Archive::Entry *dir = createDirectory(100);
+    QVERIFY(dir->find(QStringLiteral("file0.txt")));
+
+    auto added = new Archive::Entry(dir, QStringLiteral("dir/added.txt"));
+    dir->appendEntry(added);
+    QCOMPARE(dir->find(QStringLiteral("added.txt")), added);
+
+    dir->removeEntryAt(0);
+    QVERIFY(!dir->find(QStringLiteral("file0.txt")));
+
+    added->setFullPath(QStringLiteral("dir/renamed.txt"));
+    QVERIFY(!dir->find(QStringLiteral("added.txt")));
+    QCOMPARE(dir->find(QStringLiteral("renamed.txt")), added);
+
+    auto replacement = new Archive::Entry(dir, QStringLiteral("dir/replacement.txt"));
+    dir->setEntryAt(0, replacement);
+    QVERIFY(!dir->find(QStringLiteral("file1.txt")));
+    QCOMPARE(dir->find(QStringLiteral("replacement.txt")), replacement);
+}
+
+void ArchiveEntryTest::testRow()
+{
+    Archive::Entry *dir = createDirectory(10);
+    for (int i = 0; i < 10; ++i) {
+        QCOMPARE(dir->entries().at(i)->row(), i);
+    }
+
+    Archive::Entry *removed = dir->entries().at(3);
+    dir->removeEntryAt(3);
+    QCOMPARE(removed->row(), -1);
+    for (int i = 0; i < dir->entries().count(); ++i) {
+        QCOMPARE(dir->entries().at(i)->row(), i);
+    }
+
+    auto replacement = new Archive::Entry(dir, QStringLiteral("dir/replacement.txt"));
+    Archive::Entry *replaced = dir->entries().at(5);
+    dir->setEntryAt(5, replacement);
+    QCOMPARE(replacement->row(), 5);
+    QCOMPARE(replaced->row(), -1);
+}
+
+#include "archiveentrytest.moc"
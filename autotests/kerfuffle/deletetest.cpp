@@ -116,6 +116,19 @@ void DeleteTest::testDelete()
     QFETCH(uint, expectedRemainingEntriesCount);
     QCOMPARE(archive->numberOfEntries(), expectedRemainingEntriesCount);
 
+    // The remaining entries must still be readable from the rewritten archive.
+    auto reloadJob = Archive::load(archivePath, plugin);
+    QVERIFY(reloadJob);
+    reloadJob->setAutoDelete(false);
+
+    TestHelper::startAndWaitForResult(reloadJob);
+    auto reloadedArchive = reloadJob->archive();
+    QVERIFY(reloadedArchive);
+    QVERIFY(reloadedArchive->isValid());
+    QCOMPARE(reloadedArchive->numberOfEntries(), expectedRemainingEntriesCount);
+
+    reloadJob->deleteLater();
+    reloadedArchive->deleteLater();
     loadJob->deleteLater();
     archive->deleteLater();
 }
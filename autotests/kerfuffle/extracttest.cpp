@@ -342,6 +342,28 @@ void ExtractTest::testExtraction_data()
         qDebug() << "lz4 executable not found in path. Skipping lz4 test.";
     }
 
+    // Only run test for zstd-compressed tar if libarchive supports zstd.
+    if (PluginManager().supportedMimeTypes().contains(QStringLiteral("application/x-zstd-compressed-tar"))) {
+        archivePath = QFINDTESTDATA("data/simplearchive.tar.zst");
+        QTest::newRow("extract selected entries from a zstd-compressed tarball without path")
+                << archivePath
+                << QVector<Archive::Entry*> {
+                       new Archive::Entry(this, QStringLiteral("file3.txt"), QString()),
+                       new Archive::Entry(this, QStringLiteral("dir2/file22.txt"), QString())
+                   }
+                << optionsNoPaths
+                << 2;
+
+        archivePath = QFINDTESTDATA("data/simplearchive.tar.zst");
+        QTest::newRow("extract all entries from a zstd-compressed tarball with path")
+                << archivePath
+                << QVector<Archive::Entry*>()
+                << optionsPreservePaths
+                << 7;
+    } else {
+        qDebug() << "tar.zst format not available. Skipping zstd test.";
+    }
+
     archivePath = QFINDTESTDATA("data/simplearchive.xar");
     QTest::newRow("extract selected entries from a xar archive without path")
             << archivePath
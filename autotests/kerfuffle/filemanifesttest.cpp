@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2026 The Ark developers <kde-utils-devel@kde.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES ( INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION ) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * ( INCLUDING NEGLIGENCE OR OTHERWISE ) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "filemanifest.h"
+
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+using namespace Kerfuffle;
+
+class FileManifestTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void testScan_data();
+    void testScan();
+    void testFile();
+    void testSymlinks();
+
+private:
+    void createFile(const QString &path);
+
+    QTemporaryDir m_tempDir;
+};
+
+QTEST_GUILESS_MAIN(FileManifestTest)
+
+void FileManifestTest::createFile(const QString &path)
+{
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write(path.toUtf8());
+}
+
+void FileManifestTest::initTestCase()
+{
+    QVERIFY(m_tempDir.isValid());
+
+    const QDir root(m_tempDir.path());
+    for (int i = 0; i < 5; ++i) {
+        const QString dir = QStringLiteral("tree/dir%1/sub").arg(i);
+        QVERIFY(root.mkpath(dir));
+        createFile(root.filePath(QStringLiteral("tree/file%1.txt").arg(i)));
+        for (int j = 0; j < 10; ++j) {
+            createFile(root.filePath(QStringLiteral("%1/file%2.txt").arg(dir).arg(j)));
+        }
+    }
+    QVERIFY(root.mkpath(QStringLiteral("tree/empty")));
+    createFile(root.filePath(QStringLiteral("single.txt")));
+}
+
+void FileManifestTest::testScan_data()
+{
+    QTest::addColumn<int>("threadCount");
+
+    QTest::newRow("one thread") << 1;
+    QTest::newRow("four threads") << 4;
+}
+
+void FileManifestTest::testScan()
+{
+    QFETCH(int, threadCount);
+
+    const QString tree = m_tempDir.path() + QLatin1String("/tree");
+    const QString single = m_tempDir.path() + QLatin1String("/single.txt");
+
+    QStringList expectedPaths;
+    expectedPaths << tree;
+    QDirIterator it(tree, QDir::AllEntries | QDir::Hidden | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        const QString path = it.next();
+        expectedPaths << (it.fileInfo().isDir() ? path + QLatin1Char('/') : path);
+    }
+    expectedPaths << single;
+
+    const FileManifest manifest = FileManifest::scan(QStringList() << tree << single, threadCount);
+    QCOMPARE(manifest.count(), expectedPaths.count());
+
+    QStringList paths;
+    foreach (const FileManifest::File &file, manifest.files()) {
+        paths << file.path;
+        QCOMPARE(file.isDir, file.path.endsWith(QLatin1Char('/')) || file.path == tree);
+    }
+
+    // The files under a directory are listed right after it.
+    QCOMPARE(paths.first(), tree);
+    QCOMPARE(paths.last(), single);
+    for (int i = 1; i < paths.count() - 1; ++i) {
+        const QString parent = paths.at(i).left(paths.at(i).lastIndexOf(QLatin1Char('/'), -2) + 1);
+        const int parentIndex = parent == tree + QLatin1Char('/') ? 0 : paths.indexOf(parent);
+        QVERIFY2(parentIndex >= 0 && parentIndex < i, qPrintable(paths.at(i)));
+        for (int j = parentIndex + 1; j < i; ++j) {
+            QVERIFY2(paths.at(j).startsWith(parent), qPrintable(paths.at(i)));
+        }
+    }
+
+    paths.sort();
+    expectedPaths.sort();
+    QCOMPARE(paths, expectedPaths);
+}
+
+void FileManifestTest::testFile()
+{
+    const QString path = m_tempDir.path() + QLatin1String("/single.txt");
+    const FileManifest manifest = FileManifest::scan(QStringList() << path);
+    QCOMPARE(manifest.count(), 1);
+
+    const FileManifest::File &file = manifest.files().first();
+    QCOMPARE(file.path, path);
+    QVERIFY(!file.isDir);
+    QVERIFY(!file.isSymLink);
+#ifndef Q_OS_WIN
+    QCOMPARE(qint64(file.status.st_size), QFileInfo(path).size());
+#endif
+}
+
+void FileManifestTest::testSymlinks()
+{
+#ifdef Q_OS_WIN
+    QSKIP("Symlinks are not tested on Windows");
+#endif
+    const QDir root(m_tempDir.path());
+    QVERIFY(root.mkpath(QStringLiteral("links")));
+    QVERIFY(QFile::link(root.filePath(QStringLiteral("tree")), root.filePath(QStringLiteral("links/tree"))));
+    QVERIFY(QFile::link(root.filePath(QStringLiteral("links")), root.filePath(QStringLiteral("linkToLinks"))));
+
+    // The added symlink is followed, the one found under it is not.
+    const FileManifest manifest = FileManifest::scan(QStringList() << root.filePath(QStringLiteral("linkToLinks")));
+    QCOMPARE(manifest.count(), 2);
+    QVERIFY(manifest.files().at(0).isSymLink);
+    QVERIFY(!manifest.files().at(0).isDir);
+    QVERIFY(manifest.files().at(1).isSymLink);
+    QVERIFY(!manifest.files().at(1).isDir);
+    QCOMPARE(manifest.files().at(1).path, root.filePath(QStringLiteral("linkToLinks/tree")));
+}
+
+#include "filemanifesttest.moc"
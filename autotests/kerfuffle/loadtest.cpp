@@ -165,6 +165,17 @@ void LoadTest::testProperties_data()
         qDebug() << "lz4 executable not found in path. Skipping lz4 test.";
     }
 
+    // Only run test for zstd-compressed tar if libarchive supports zstd.
+    if (PluginManager().supportedMimeTypes().contains(QStringLiteral("application/x-zstd-compressed-tar"))) {
+        QTest::newRow("zstd-compressed tarball")
+                << QFINDTESTDATA("data/simplearchive.tar.zst")
+                << QStringLiteral("simplearchive")
+                << false << false << false << false << false << 0 << Archive::Unencrypted
+                << QStringLiteral("simplearchive");
+    } else {
+        qDebug() << "tar.zst format not available. Skipping zstd test.";
+    }
+
     QTest::newRow("xar archive")
             << QFINDTESTDATA("data/simplearchive.xar")
             << QStringLiteral("simplearchive")
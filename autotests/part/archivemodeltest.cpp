@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2026 The Ark developers <kde-utils-devel@kde.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES ( INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION ) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * ( INCLUDING NEGLIGENCE OR OTHERWISE ) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "archivemodel.h"
+
+#include <QSignalSpy>
+#include <QTest>
+
+using Kerfuffle::Archive;
+
+class ArchiveModelTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void init();
+    void cleanup();
+    void testParent();
+    void testNewEntries();
+    void benchmarkParent();
+
+private:
+    void listEntry(const QString &fullPath, bool isDirectory);
+    void listWideDirectory(int children);
+
+    ArchiveModel *m_model = nullptr;
+};
+
+QTEST_MAIN(ArchiveModelTest)
+
+void ArchiveModelTest::init()
+{
+    m_model = new ArchiveModel(QString(), this);
+}
+
+void ArchiveModelTest::cleanup()
+{
+    delete m_model;
+    m_model = nullptr;
+}
+
+void ArchiveModelTest::listEntry(const QString &fullPath, bool isDirectory)
+{
+    // Entries are not owned by the model, parent them to the test instead.
+    auto entry = new Archive::Entry(this, fullPath);
+    entry->setProperty("isDirectory", isDirectory);
+    entry->setProperty("size", 1);
+    QVERIFY(QMetaObject::invokeMethod(m_model, "slotListEntry", Q_ARG(Archive::Entry*, entry)));
+}
+
+// Creates a "big/" directory with the given number of subdirectories,
+// each one containing a single file.
+void ArchiveModelTest::listWideDirectory(int children)
+{
+    listEntry(QStringLiteral("big/"), true);
+    for (int i = 0; i < children; ++i) {
+        listEntry(QStringLiteral("big/dir%1/").arg(i), true);
+        listEntry(QStringLiteral("big/dir%1/file.txt").arg(i), false);
+    }
+}
+
+void ArchiveModelTest::testParent()
+{
+    listWideDirectory(100);
+
+    QCOMPARE(m_model->rowCount(), 1);
+    const QModelIndex bigIndex = m_model->index(0, 0);
+    QCOMPARE(m_model->rowCount(bigIndex), 100);
+
+    for (int row = 0; row < 100; ++row) {
+        const QModelIndex dirIndex = m_model->index(row, 0, bigIndex);
+        QCOMPARE(m_model->parent(dirIndex), bigIndex);
+
+        const QModelIndex fileIndex = m_model->index(0, 0, dirIndex);
+        QVERIFY(fileIndex.isValid());
+        QCOMPARE(m_model->parent(fileIndex), dirIndex);
+    }
+}
+
+void ArchiveModelTest::testNewEntries()
+{
+    listEntry(QStringLiteral("dir/"), true);
+
+    QVector<Archive::Entry*> entries;
+    for (int i = 0; i < 10; ++i) {
+        entries << new Archive::Entry(this, QStringLiteral("dir/file%1.txt").arg(i));
+    }
+    // A duplicated entry must be merged, not inserted twice.
+    auto duplicate = new Archive::Entry(this, QStringLiteral("dir/file0.txt"));
+    duplicate->setProperty("compressedSize", 10);
+    entries << duplicate;
+    entries << new Archive::Entry(this, QStringLiteral("other/file.txt"));
+
+    QSignalSpy spy(m_model, &QAbstractItemModel::rowsInserted);
+    QVERIFY(QMetaObject::invokeMethod(m_model, "slotNewEntries", Q_ARG(QVector<Archive::Entry*>, entries)));
+
+    const QModelIndex dirIndex = m_model->index(0, 0);
+    QCOMPARE(m_model->rowCount(dirIndex), 10);
+    QCOMPARE(m_model->rowCount(), 2);
+
+    // One notification for the ten files, one for the implicitly
+    // created "other/" directory and one for its file.
+    QCOMPARE(spy.count(), 3);
+    QCOMPARE(spy.at(0).at(1).toInt(), 0);
+    QCOMPARE(spy.at(0).at(2).toInt(), 9);
+}
+
+void ArchiveModelTest::benchmarkParent()
+{
+    const int children = 100000;
+    listWideDirectory(children);
+
+    const QModelIndex bigIndex = m_model->index(0, 0);
+    QCOMPARE(m_model->rowCount(bigIndex), children);
+
+    QVector<QModelIndex> fileIndexes;
+    fileIndexes.reserve(children);
+    for (int row = 0; row < children; ++row) {
+        fileIndexes << m_model->index(0, 0, m_model->index(row, 0, bigIndex));
+    }
+
+    // Every parent lookup needs the row of a directory with 100k siblings.
+    QBENCHMARK {
+        foreach (const QModelIndex &fileIndex, fileIndexes) {
+            m_model->parent(fileIndex);
+        }
+    }
+}
+
+#include "archivemodeltest.moc"
@@ -29,6 +29,7 @@
 #include "jobs.h"
 #include "testhelper.h"
 
+#include <QDir>
 #include <QFile>
 #include <QSignalSpy>
 #include <QTest>
@@ -40,6 +41,40 @@ QTEST_GUILESS_MAIN(Cli7zTest)
 
 using namespace Kerfuffle;
 
+/**
+ * Records whether the listing process was run with a pseudo-terminal,
+ * and can force one to compare both transports.
+ */
+class TransportCliPlugin : public CliPlugin
+{
+public:
+    TransportCliPlugin(QObject *parent, const QVariantList &args, bool forcePseudoTerminal)
+        : CliPlugin(parent, args)
+        , m_forcePseudoTerminal(forcePseudoTerminal)
+    {
+    }
+
+    bool needsInteractiveInput() const override
+    {
+        return m_forcePseudoTerminal || CliPlugin::needsInteractiveInput();
+    }
+
+    bool readListLine(const QString &line) override
+    {
+        m_usedPseudoTerminal = m_process->inherits("KPtyProcess");
+        return CliPlugin::readListLine(line);
+    }
+
+    bool usedPseudoTerminal() const
+    {
+        return m_usedPseudoTerminal;
+    }
+
+private:
+    bool m_forcePseudoTerminal;
+    bool m_usedPseudoTerminal = false;
+};
+
 void Cli7zTest::initTestCase()
 {
     m_plugin = new Plugin(this);
@@ -475,3 +510,131 @@ void Cli7zTest::testExtractArgs()
     plugin->deleteLater();
 }
 
+void Cli7zTest::testClassifyLine_data()
+{
+    QTest::addColumn<QString>("line");
+    QTest::addColumn<int>("expectedTypes");
+
+    QTest::newRow("listing line")
+            << QStringLiteral("Path = testarchive/dir1/file1.txt")
+            << static_cast<int>(CliProperties::NoMessage);
+    QTest::newRow("password prompt")
+            << QStringLiteral("Enter password (will not be echoed):")
+            << static_cast<int>(CliProperties::PasswordPrompt);
+    QTest::newRow("wrong password")
+            << QStringLiteral("ERROR: Wrong password : file.txt")
+            << static_cast<int>(CliProperties::WrongPassword);
+    QTest::newRow("test passed")
+            << QStringLiteral("Everything is Ok")
+            << static_cast<int>(CliProperties::TestPassed);
+    QTest::newRow("test passed, not anchored")
+            << QStringLiteral("Not everything is Ok")
+            << static_cast<int>(CliProperties::NoMessage);
+    QTest::newRow("file exists")
+            << QStringLiteral("? (Y)es / (N)o / (A)lways / (S)kip all / A(u)to rename all / (Q)uit? ")
+            << static_cast<int>(CliProperties::FileExists);
+    QTest::newRow("file exists file name")
+            << QStringLiteral("file ./dir/file.txt")
+            << static_cast<int>(CliProperties::FileExistsFileName);
+    QTest::newRow("corrupt archive and disk full")
+            << QStringLiteral("Headers Error: No space left on device")
+            << static_cast<int>(CliProperties::CorruptArchive | CliProperties::DiskFull);
+}
+
+void Cli7zTest::testClassifyLine()
+{
+    CliPlugin *plugin = new CliPlugin(this, {QStringLiteral("dummy.7z"),
+                                             QVariant::fromValue(m_plugin->metaData())});
+
+    QFETCH(QString, line);
+    QFETCH(int, expectedTypes);
+
+    QCOMPARE(static_cast<int>(plugin->cliProperties()->classifyLine(line)), expectedTypes);
+
+    plugin->deleteLater();
+}
+
+void Cli7zTest::benchmarkClassifyListOutput()
+{
+    CliPlugin *plugin = new CliPlugin(this, {QStringLiteral("dummy.7z"),
+                                             QVariant::fromValue(m_plugin->metaData())});
+
+    QStringList lines;
+    foreach (const QString &fileName, QDir(QFINDTESTDATA("data")).entryList({QStringLiteral("*.txt")}, QDir::Files)) {
+        QFile outputText(QFINDTESTDATA("data/") + fileName);
+        QVERIFY(outputText.open(QIODevice::ReadOnly));
+        QTextStream outputStream(&outputText);
+        while (!outputStream.atEnd()) {
+            lines << outputStream.readLine();
+        }
+    }
+    QVERIFY(!lines.isEmpty());
+
+    // Every line of a listing is checked against all the plugin's patterns.
+    const CliProperties *cliProperties = plugin->cliProperties();
+    QBENCHMARK {
+        foreach (const QString &line, lines) {
+            cliProperties->classifyLine(line);
+        }
+    }
+
+    plugin->deleteLater();
+}
+
+void Cli7zTest::testListTransport()
+{
+    if (!m_plugin->isValid()) {
+        QSKIP("cli7z plugin not available. Skipping test.", SkipSingle);
+    }
+
+    // An unencrypted archive listed without a password doesn't need a pseudo-terminal.
+    TransportCliPlugin *plugin = new TransportCliPlugin(this, {QFINDTESTDATA("data/one_toplevel_folder.7z"),
+                                                               QVariant::fromValue(m_plugin->metaData())},
+                                                        false);
+    QVERIFY(!plugin->needsInteractiveInput());
+
+    QSignalSpy spy(plugin, &ReadOnlyArchiveInterface::finished);
+    TestHelper::startAndWaitForResult(new LoadJob(plugin));
+    QCOMPARE(spy.count(), 1);
+    QVERIFY(spy.at(0).at(0).toBool());
+    QVERIFY(!plugin->usedPseudoTerminal());
+
+    plugin->deleteLater();
+}
+
+void Cli7zTest::benchmarkListTransport_data()
+{
+    QTest::addColumn<bool>("forcePseudoTerminal");
+
+    QTest::newRow("pipe") << false;
+    QTest::newRow("pseudo-terminal") << true;
+}
+
+void Cli7zTest::benchmarkListTransport()
+{
+    if (!m_plugin->isValid()) {
+        QSKIP("cli7z plugin not available. Skipping test.", SkipSingle);
+    }
+
+    // The bundled archive is tiny, set ARK_BENCHMARK_ARCHIVE to a large
+    // unencrypted 7z archive to measure the transports' throughput.
+    QString archivePath = QFile::decodeName(qgetenv("ARK_BENCHMARK_ARCHIVE"));
+    if (archivePath.isEmpty()) {
+        archivePath = QFINDTESTDATA("data/one_toplevel_folder.7z");
+    }
+
+    QFETCH(bool, forcePseudoTerminal);
+    QBENCHMARK {
+        TransportCliPlugin *plugin = new TransportCliPlugin(this, {archivePath,
+                                                                   QVariant::fromValue(m_plugin->metaData())},
+                                                            forcePseudoTerminal);
+
+        QSignalSpy spy(plugin, &ReadOnlyArchiveInterface::finished);
+        TestHelper::startAndWaitForResult(new LoadJob(plugin));
+        QCOMPARE(spy.count(), 1);
+        QVERIFY(spy.at(0).at(0).toBool());
+        QCOMPARE(plugin->usedPseudoTerminal(), forcePseudoTerminal);
+
+        plugin->deleteLater();
+    }
+}
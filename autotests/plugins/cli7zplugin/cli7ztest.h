@@ -46,6 +46,12 @@ private Q_SLOTS:
     void testAddArgs();
     void testExtractArgs_data();
     void testExtractArgs();
+    void testClassifyLine_data();
+    void testClassifyLine();
+    void benchmarkClassifyListOutput();
+    void testListTransport();
+    void benchmarkListTransport_data();
+    void benchmarkListTransport();
 
 private:
     PluginManager m_pluginManger;
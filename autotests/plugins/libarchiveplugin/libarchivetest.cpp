@@ -0,0 +1,373 @@
+/*
+ * Copyright (c) 2026 The Ark developers <kde-utils-devel@kde.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES ( INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION ) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * ( INCLUDING NEGLIGENCE OR OTHERWISE ) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "libarchivetest.h"
+#include "archive_kerfuffle.h"
+#include "entryselection.h"
+#include "jobs.h"
+#include "parallelgzipwriter.h"
+#include "pathmapping.h"
+#include "testhelper.h"
+
+#include <QBuffer>
+#include <QTest>
+
+#include <zlib.h>
+
+#include <cstring>
+
+QTEST_GUILESS_MAIN(LibarchiveTest)
+
+using namespace Kerfuffle;
+
+/**
+ * Decompresses all the members of the gzip file @p compressed.
+ * @p ok is set to whether the file ends with a complete member.
+ */
+static QByteArray gunzip(const QByteArray &compressed, int *members, bool *ok)
+{
+    QByteArray result;
+    *members = 0;
+    *ok = false;
+
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    // 16 makes zlib expect a gzip header.
+    if (inflateInit2(&stream, 15 + 16) != Z_OK) {
+        return result;
+    }
+
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(compressed.constData()));
+    stream.avail_in = static_cast<uInt>(compressed.size());
+
+    QByteArray buffer(64 * 1024, Qt::Uninitialized);
+    int ret;
+    do {
+        stream.next_out = reinterpret_cast<Bytef*>(buffer.data());
+        stream.avail_out = static_cast<uInt>(buffer.size());
+        ret = inflate(&stream, Z_NO_FLUSH);
+        result.append(buffer.constData(), buffer.size() - static_cast<int>(stream.avail_out));
+
+        if (ret == Z_STREAM_END) {
+            (*members)++;
+            if (stream.avail_in == 0) {
+                *ok = true;
+                break;
+            }
+            // The next member starts right after this one.
+            inflateReset(&stream);
+            ret = Z_OK;
+        }
+    } while (ret == Z_OK);
+
+    inflateEnd(&stream);
+    return result;
+}
+
+void LibarchiveTest::initTestCase()
+{
+    m_plugin = new Plugin(this);
+    foreach (Plugin *plugin, m_pluginManager.availablePlugins()) {
+        if (plugin->metaData().pluginId() == QStringLiteral("kerfuffle_libarchive")) {
+            m_plugin = plugin;
+            return;
+        }
+    }
+}
+
+void LibarchiveTest::testEntrySelection_data()
+{
+    QTest::addColumn<QStringList>("selectedPaths");
+    QTest::addColumn<QStringList>("matchingPaths");
+    QTest::addColumn<QStringList>("notMatchingPaths");
+    QTest::addColumn<bool>("completeWhenExtracted");
+
+    QTest::newRow("files")
+            << QStringList {QStringLiteral("a.txt"), QStringLiteral("dir/b.txt")}
+            << QStringList {QStringLiteral("a.txt"), QStringLiteral("dir/b.txt")}
+            << QStringList {QStringLiteral("b.txt"), QStringLiteral("dir/"), QStringLiteral("dir/a.txt"), QStringLiteral("a.txt/b")}
+            << true;
+
+    QTest::newRow("directory without its contents")
+            << QStringList {QStringLiteral("dir/")}
+            << QStringList {QStringLiteral("dir/"), QStringLiteral("dir"), QStringLiteral("dir/a.txt"), QStringLiteral("dir/sub/b.txt")}
+            << QStringList {QStringLiteral("dir2/a.txt"), QStringLiteral("a.txt"), QStringLiteral("di/a.txt")}
+            << false;
+
+    QTest::newRow("directory with its contents")
+            << QStringList {QStringLiteral("dir/"), QStringLiteral("dir/a.txt"), QStringLiteral("dir/sub/")}
+            << QStringList {QStringLiteral("dir/"), QStringLiteral("dir/a.txt"), QStringLiteral("dir/sub/"), QStringLiteral("dir/sub/b.txt")}
+            << QStringList {QStringLiteral("dir/b.txt"), QStringLiteral("dir2/a.txt")}
+            << false;
+
+    QTest::newRow("directories with their contents")
+            << QStringList {QStringLiteral("dir/"), QStringLiteral("dir/a.txt"), QStringLiteral("dir b/"), QStringLiteral("dir b/a.txt")}
+            << QStringList {QStringLiteral("dir/"), QStringLiteral("dir/a.txt"), QStringLiteral("dir b/a.txt")}
+            << QStringList {QStringLiteral("dir/b.txt"), QStringLiteral("dir b/b.txt")}
+            << true;
+}
+
+void LibarchiveTest::testEntrySelection()
+{
+    QFETCH(QStringList, selectedPaths);
+    QVector<Archive::Entry*> entries;
+    foreach (const QString &path, selectedPaths) {
+        entries << new Archive::Entry(this, path);
+    }
+
+    EntrySelection selection(entries);
+    QVERIFY(!selection.isEmpty());
+    QVERIFY(!selection.isComplete());
+
+    QFETCH(QStringList, matchingPaths);
+    foreach (const QString &path, matchingPaths) {
+        QVERIFY2(selection.match(path), qPrintable(path));
+    }
+
+    QFETCH(QStringList, notMatchingPaths);
+    foreach (const QString &path, notMatchingPaths) {
+        QVERIFY2(!selection.match(path), qPrintable(path));
+    }
+
+    foreach (const QString &path, selectedPaths) {
+        const Archive::Entry *entry = selection.match(path);
+        QVERIFY(entry);
+        selection.setExtracted(entry);
+    }
+
+    QFETCH(bool, completeWhenExtracted);
+    QCOMPARE(selection.isComplete(), completeWhenExtracted);
+
+    qDeleteAll(entries);
+}
+
+void LibarchiveTest::benchmarkEntrySelection()
+{
+    // 50k files selected in a 500k entries archive.
+    QStringList paths;
+    QVector<Archive::Entry*> entries;
+    for (int i = 0; i < 500000; ++i) {
+        paths << QStringLiteral("dir%1/file%2").arg(i % 100).arg(i);
+        if (i % 10 == 0) {
+            entries << new Archive::Entry(this, paths.last());
+        }
+    }
+
+    QBENCHMARK {
+        EntrySelection selection(entries);
+        foreach (const QString &path, paths) {
+            const Archive::Entry *entry = selection.match(path);
+            if (entry) {
+                selection.setExtracted(entry);
+            }
+        }
+        QVERIFY(selection.isComplete());
+    }
+
+    qDeleteAll(entries);
+}
+
+void LibarchiveTest::testPathMapping_data()
+{
+    QTest::addColumn<int>("rule");
+    QTest::addColumn<QStringList>("oldPaths");
+    QTest::addColumn<QStringList>("newPaths");
+    QTest::addColumn<QStringList>("paths");
+    QTest::addColumn<QStringList>("expectedPaths");
+
+    QTest::newRow("removed files")
+            << int(PathMapping::Subtree)
+            << QStringList {QStringLiteral("a.txt"), QStringLiteral("dir/b.txt")}
+            << QStringList()
+            << QStringList {QStringLiteral("a.txt"), QStringLiteral("dir/b.txt"), QStringLiteral("dir/a.txt"), QStringLiteral("a.txt/b")}
+            << QStringList {QString(), QString(), QStringLiteral("-"), QStringLiteral("-")};
+
+    QTest::newRow("removed directory")
+            << int(PathMapping::Subtree)
+            << QStringList {QStringLiteral("dir/")}
+            << QStringList()
+            << QStringList {QStringLiteral("dir/"), QStringLiteral("dir/a.txt"), QStringLiteral("dir/sub/"), QStringLiteral("dir2/a.txt")}
+            << QStringList {QString(), QString(), QString(), QStringLiteral("-")};
+
+    QTest::newRow("added directory")
+            << int(PathMapping::ExactPaths)
+            << QStringList {QStringLiteral("dir/"), QStringLiteral("dir/a.txt")}
+            << QStringList()
+            << QStringList {QStringLiteral("dir/"), QStringLiteral("dir/a.txt"), QStringLiteral("dir/b.txt")}
+            << QStringList {QString(), QString(), QStringLiteral("-")};
+
+    QTest::newRow("moved directory")
+            << int(PathMapping::Subtree)
+            << QStringList {QStringLiteral("dir/"), QStringLiteral("dir/a.txt"), QStringLiteral("c.txt")}
+            << QStringList {QStringLiteral("new/dir/"), QStringLiteral("new/dir/a.txt"), QStringLiteral("new/c.txt")}
+            << QStringList {QStringLiteral("dir/a.txt"), QStringLiteral("dir/sub/b.txt"), QStringLiteral("dir/sub/"), QStringLiteral("c.txt"), QStringLiteral("d.txt")}
+            << QStringList {QStringLiteral("new/dir/a.txt"), QStringLiteral("new/dir/sub/b.txt"), QStringLiteral("new/dir/sub/"), QStringLiteral("new/c.txt"), QStringLiteral("-")};
+}
+
+void LibarchiveTest::testPathMapping()
+{
+    QFETCH(int, rule);
+    QFETCH(QStringList, oldPaths);
+    QFETCH(QStringList, newPaths);
+
+    PathMapping mapping(static_cast<PathMapping::DirectoryRule>(rule));
+    QVERIFY(mapping.isEmpty());
+    for (int i = 0; i < oldPaths.size(); ++i) {
+        mapping.insert(oldPaths.at(i), newPaths.value(i));
+    }
+    QVERIFY(!mapping.isEmpty());
+
+    // "-" stands for the paths which are not mapped.
+    QFETCH(QStringList, paths);
+    QFETCH(QStringList, expectedPaths);
+    for (int i = 0; i < paths.size(); ++i) {
+        const QByteArray path = paths.at(i).toUtf8();
+        const bool isMapped = expectedPaths.at(i) != QLatin1String("-");
+        QCOMPARE(mapping.contains(path), isMapped);
+        QCOMPARE(QString::fromUtf8(mapping.newPath(path)), isMapped ? expectedPaths.at(i) : QString());
+    }
+}
+
+void LibarchiveTest::benchmarkPathMapping()
+{
+    // 100k entries removed from a 1M entries archive.
+    QVector<QByteArray> paths;
+    paths.reserve(1000000);
+    PathMapping mapping(PathMapping::Subtree);
+    for (int i = 0; i < 1000000; ++i) {
+        paths << QStringLiteral("dir%1/file%2").arg(i % 100).arg(i).toUtf8();
+        if (i % 10 == 0) {
+            mapping.insert(QString::fromUtf8(paths.last()));
+        }
+    }
+
+    int removedEntries = 0;
+    QBENCHMARK {
+        removedEntries = 0;
+        foreach (const QByteArray &path, paths) {
+            if (mapping.contains(path)) {
+                removedEntries++;
+            }
+        }
+    }
+
+    QCOMPARE(removedEntries, 100000);
+}
+
+void LibarchiveTest::testTestArchive_data()
+{
+    QTest::addColumn<QString>("archivePath");
+    QTest::addColumn<bool>("expectedSuccess");
+    QTest::addColumn<QStringList>("expectedFailedEntries");
+
+    QTest::newRow("valid archive")
+            << QFINDTESTDATA("data/valid.tar.xz")
+            << true
+            << QStringList();
+
+    // The archive ends in the middle of the data of b.txt.
+    QTest::newRow("truncated archive")
+            << QFINDTESTDATA("data/truncated.tar")
+            << false
+            << QStringList {QStringLiteral("b.txt")};
+
+    // The header of b.txt has a wrong checksum, the reader skips to c.txt.
+    QTest::newRow("archive with a damaged header")
+            << QFINDTESTDATA("data/damaged.tar")
+            << false
+            << QStringList {QStringLiteral("damaged.tar")};
+}
+
+void LibarchiveTest::testTestArchive()
+{
+    QFETCH(QString, archivePath);
+    auto archive = TestHelper::loadArchive(archivePath, QStringLiteral("kerfuffle_libarchive"), this);
+    if (!archive) {
+        QSKIP("libarchive plugin not available. Skipping test.", SkipSingle);
+    }
+
+    TestJob *testJob = TestHelper::testArchive(archive);
+
+    QFETCH(bool, expectedSuccess);
+    QCOMPARE(testJob->testSucceeded(), expectedSuccess);
+
+    QFETCH(QStringList, expectedFailedEntries);
+    const QStringList failedEntries = testJob->failedEntries();
+    QCOMPARE(failedEntries.size(), expectedFailedEntries.size());
+    for (int i = 0; i < failedEntries.size(); i++) {
+        QVERIFY2(failedEntries.at(i).startsWith(expectedFailedEntries.at(i)), qPrintable(failedEntries.at(i)));
+    }
+
+    testJob->deleteLater();
+    archive->deleteLater();
+}
+
+void LibarchiveTest::testParallelGzipWriter_data()
+{
+    QTest::addColumn<int>("threadCount");
+    QTest::addColumn<int>("inputSize");
+    QTest::addColumn<int>("writeSize");
+
+    // The writer compresses blocks of 1 MiB.
+    QTest::newRow("one thread") << 1 << 3 * 1024 * 1024 << 64 * 1024;
+    QTest::newRow("several threads") << 4 << 3 * 1024 * 1024 << 64 * 1024;
+    QTest::newRow("several threads, partial last block") << 4 << 5 * 1024 * 1024 + 12345 << 10000;
+    QTest::newRow("several threads, writes larger than a block") << 3 << 4 * 1024 * 1024 + 1 << 3 * 1024 * 1024;
+    QTest::newRow("several threads, less than a block") << 4 << 1000 << 64 * 1024;
+}
+
+void LibarchiveTest::testParallelGzipWriter()
+{
+    QFETCH(int, threadCount);
+    QFETCH(int, inputSize);
+    QFETCH(int, writeSize);
+
+    // Compressible, but not made of one repeated block.
+    QByteArray input;
+    input.reserve(inputSize);
+    for (int i = 0; input.size() < inputSize; i++) {
+        input += "line " + QByteArray::number(i) + ": " + QByteArray::number(i * 2654435761u, 16) + '\n';
+    }
+    input.truncate(inputSize);
+
+    QBuffer device;
+    QVERIFY(device.open(QIODevice::WriteOnly));
+    {
+        ParallelGzipWriter writer(&device, threadCount, -1);
+        for (int offset = 0; offset < input.size(); offset += writeSize) {
+            QVERIFY(writer.write(input.constData() + offset, qMin(writeSize, input.size() - offset)));
+        }
+        QVERIFY(writer.close());
+    }
+    device.close();
+
+    int members;
+    bool ok;
+    const QByteArray output = gunzip(device.data(), &members, &ok);
+    QVERIFY(ok);
+    QCOMPARE(members, qMax(1, (inputSize + 1024 * 1024 - 1) / (1024 * 1024)));
+    QCOMPARE(output.size(), input.size());
+    QVERIFY(output == input);
+}
@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2026 The Ark developers <kde-utils-devel@kde.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES ( INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION ) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * ( INCLUDING NEGLIGENCE OR OTHERWISE ) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "singlefiletest.h"
+#include "archive_kerfuffle.h"
+#include "jobs.h"
+#include "parallelbzip2decompressor.h"
+#include "parallelgzipdecompressor.h"
+#include "parallelxzdecompressor.h"
+#include "testhelper.h"
+
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+using namespace Kerfuffle;
+
+QTEST_GUILESS_MAIN(SingleFileTest)
+
+void SingleFileTest::testExtraction_data()
+{
+    QTest::addColumn<QString>("pluginId");
+    QTest::addColumn<QString>("archivePath");
+    QTest::addColumn<bool>("expectedSuccess");
+
+    // The files are decompressed from several threads when there are several cores.
+    QTest::newRow("multi-member gzip")
+            << QStringLiteral("kerfuffle_libgz")
+            << QFINDTESTDATA("data/text.txt.gz")
+            << true;
+
+    QTest::newRow("two bzip2 streams of two blocks")
+            << QStringLiteral("kerfuffle_libbz2")
+            << QFINDTESTDATA("data/text.txt.bz2")
+            << true;
+
+    QTest::newRow("xz stream of five blocks")
+            << QStringLiteral("kerfuffle_libxz")
+            << QFINDTESTDATA("data/text.txt.xz")
+            << true;
+
+    QTest::newRow("corrupted bzip2 block")
+            << QStringLiteral("kerfuffle_libbz2")
+            << QFINDTESTDATA("data/corrupted.txt.bz2")
+            << false;
+
+    QTest::newRow("corrupted xz block")
+            << QStringLiteral("kerfuffle_libxz")
+            << QFINDTESTDATA("data/corrupted.txt.xz")
+            << false;
+}
+
+void SingleFileTest::testExtraction()
+{
+    QFETCH(QString, pluginId);
+    QFETCH(QString, archivePath);
+    auto archive = TestHelper::loadArchive(archivePath, pluginId, this);
+    if (!archive) {
+        QSKIP("Plugin not available. Skipping test.", SkipSingle);
+    }
+
+    QTemporaryDir destDir;
+    if (!destDir.isValid()) {
+        QSKIP("Could not create a temporary directory for extraction. Skipping test.", SkipSingle);
+    }
+
+    auto extractionJob = archive->extractFiles({}, destDir.path());
+    QVERIFY(extractionJob);
+    extractionJob->setAutoDelete(false);
+    TestHelper::startAndWaitForResult(extractionJob);
+
+    QFETCH(bool, expectedSuccess);
+    QCOMPARE(extractionJob->error() == KJob::NoError, expectedSuccess);
+
+    if (expectedSuccess) {
+        QFile extractedFile(destDir.path() + QLatin1String("/text.txt"));
+        QVERIFY(extractedFile.open(QIODevice::ReadOnly));
+
+        QCryptographicHash hash(QCryptographicHash::Sha256);
+        QVERIFY(hash.addData(&extractedFile));
+        QCOMPARE(hash.result().toHex(), QByteArray("aad34f29f46fc47866ee3192c511b2ca1673b8964e8d0421a4fc2c974cc9015a"));
+    }
+
+    extractionJob->deleteLater();
+    archive->deleteLater();
+}
+
+void SingleFileTest::testParallelDecompressor_data()
+{
+    QTest::addColumn<QString>("format");
+    QTest::addColumn<QString>("archivePath");
+    QTest::addColumn<bool>("expectedSuccess");
+
+    QTest::newRow("multi-member gzip")
+            << QStringLiteral("gz")
+            << QFINDTESTDATA("data/text.txt.gz")
+            << true;
+
+    QTest::newRow("two bzip2 streams of two blocks")
+            << QStringLiteral("bz2")
+            << QFINDTESTDATA("data/text.txt.bz2")
+            << true;
+
+    QTest::newRow("xz stream of five blocks")
+            << QStringLiteral("xz")
+            << QFINDTESTDATA("data/text.txt.xz")
+            << true;
+
+    QTest::newRow("corrupted bzip2 block")
+            << QStringLiteral("bz2")
+            << QFINDTESTDATA("data/corrupted.txt.bz2")
+            << false;
+
+    QTest::newRow("corrupted xz block")
+            << QStringLiteral("xz")
+            << QFINDTESTDATA("data/corrupted.txt.xz")
+            << false;
+}
+
+void SingleFileTest::testParallelDecompressor()
+{
+    // Unlike the plugins, the decompressors do not fall back to a single thread.
+    QFETCH(QString, format);
+    QScopedPointer<ParallelDecompressor> decompressor;
+    if (format == QLatin1String("gz")) {
+        decompressor.reset(new ParallelGzipDecompressor(4));
+    } else if (format == QLatin1String("bz2")) {
+        decompressor.reset(new ParallelBzip2Decompressor(4));
+    } else {
+        decompressor.reset(new ParallelXzDecompressor(4));
+    }
+
+    QFETCH(QString, archivePath);
+    QFile input(archivePath);
+    QVERIFY(input.open(QIODevice::ReadOnly));
+
+    QBuffer output;
+    QVERIFY(output.open(QIODevice::WriteOnly));
+
+    const ParallelDecompressor::Result result = decompressor->decompress(&input, &output);
+
+    QFETCH(bool, expectedSuccess);
+    if (!expectedSuccess) {
+        QCOMPARE(result, ParallelDecompressor::InvalidData);
+        return;
+    }
+
+    QCOMPARE(result, ParallelDecompressor::Decompressed);
+    QCOMPARE(QCryptographicHash::hash(output.data(), QCryptographicHash::Sha256).toHex(),
+             QByteArray("aad34f29f46fc47866ee3192c511b2ca1673b8964e8d0421a4fc2c974cc9015a"));
+}
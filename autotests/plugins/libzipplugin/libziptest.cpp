@@ -0,0 +1,283 @@
+/*
+ * Copyright (c) 2026 The Ark developers <kde-utils-devel@kde.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES ( INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION ) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * ( INCLUDING NEGLIGENCE OR OTHERWISE ) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "libziptest.h"
+#include "archive_kerfuffle.h"
+#include "jobs.h"
+#include "queries.h"
+#include "testhelper.h"
+
+#include <KIO/RenameDialog>
+
+#include <QDirIterator>
+#include <QTemporaryDir>
+#include <QTest>
+
+using namespace Kerfuffle;
+
+QTEST_GUILESS_MAIN(LibzipTest)
+
+// Returns @p size bytes of data which deflate compresses to about half its size.
+static QByteArray testData(int size, quint32 seed)
+{
+    QByteArray data(size, Qt::Uninitialized);
+    for (int i = 0; i < size; i++) {
+        seed = seed * 1103515245 + 12345;
+        data[i] = 'a' + (seed >> 16) % 16;
+    }
+    return data;
+}
+
+void LibzipTest::testTestArchive_data()
+{
+    QTest::addColumn<QString>("archivePath");
+    QTest::addColumn<bool>("expectedSuccess");
+    QTest::addColumn<QStringList>("expectedFailedEntries");
+
+    QTest::newRow("valid archive")
+            << QFINDTESTDATA("data/valid.zip")
+            << true
+            << QStringList();
+
+    // The data of stored.txt has been modified, which only its CRC tells.
+    QTest::newRow("archive with a corrupted entry")
+            << QFINDTESTDATA("data/corrupted.zip")
+            << false
+            << QStringList {QStringLiteral("stored.txt")};
+}
+
+void LibzipTest::testTestArchive()
+{
+    QFETCH(QString, archivePath);
+    auto archive = TestHelper::loadArchive(archivePath, QStringLiteral("kerfuffle_libzip"), this);
+    if (!archive) {
+        QSKIP("libzip plugin not available. Skipping test.", SkipSingle);
+    }
+
+    TestJob *testJob = TestHelper::testArchive(archive);
+
+    QFETCH(bool, expectedSuccess);
+    QCOMPARE(testJob->testSucceeded(), expectedSuccess);
+
+    QFETCH(QStringList, expectedFailedEntries);
+    const QStringList failedEntries = testJob->failedEntries();
+    QCOMPARE(failedEntries.size(), expectedFailedEntries.size());
+    for (int i = 0; i < failedEntries.size(); i++) {
+        QVERIFY2(failedEntries.at(i).startsWith(expectedFailedEntries.at(i)), qPrintable(failedEntries.at(i)));
+    }
+
+    testJob->deleteLater();
+    archive->deleteLater();
+}
+
+void LibzipTest::testExtractToSameDestination()
+{
+    // a/file.txt and b/file.txt are both extracted to file.txt without their paths.
+    auto archive = TestHelper::loadArchive(QFINDTESTDATA("data/samename.zip"), QStringLiteral("kerfuffle_libzip"), this);
+    if (!archive) {
+        QSKIP("libzip plugin not available. Skipping test.", SkipSingle);
+    }
+
+    QTemporaryDir destDir;
+    if (!destDir.isValid()) {
+        QSKIP("Could not create a temporary directory for extraction. Skipping test.", SkipSingle);
+    }
+
+    ExtractionOptions options;
+    options.setPreservePaths(false);
+    auto extractionJob = archive->extractFiles({}, destDir.path(), options);
+    QVERIFY(extractionJob);
+    extractionJob->setAutoDelete(false);
+
+    // The file planned for the first entry does not exist yet, but the user is asked anyway.
+    int queries = 0;
+    connect(extractionJob, &Job::userQuery, this, [&queries](Query *query) {
+        queries++;
+        query->setResponse(KIO::R_OVERWRITE);
+    });
+    TestHelper::startAndWaitForResult(extractionJob);
+    QCOMPARE(queries, 1);
+
+    // Only the last entry is written, so no two threads write the same file.
+    QStringList extractedFiles;
+    QDirIterator dirIt(destDir.path(), QDir::AllEntries | QDir::Hidden | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+    while (dirIt.hasNext()) {
+        extractedFiles << QDir(destDir.path()).relativeFilePath(dirIt.next());
+    }
+    QCOMPARE(extractedFiles, QStringList {QStringLiteral("file.txt")});
+
+    QFile file(destDir.path() + QStringLiteral("/file.txt"));
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QCOMPARE(file.readAll(), QByteArray("second\n"));
+
+    extractionJob->deleteLater();
+    archive->deleteLater();
+}
+
+void LibzipTest::testExtractDirectoriesWithoutRecords_data()
+{
+    QTest::addColumn<QVector<Archive::Entry*>>("entriesToExtract");
+    QTest::addColumn<QStringList>("expectedExtractedEntries");
+
+    // The archive has no records for dir/ and dir/sub/, which only exist as parents of their files.
+    QTest::newRow("selected directory with its files")
+            << QVector<Archive::Entry*> {
+                   new Archive::Entry(this, QStringLiteral("dir/")),
+                   new Archive::Entry(this, QStringLiteral("dir/a.txt")),
+                   new Archive::Entry(this, QStringLiteral("dir/sub/")),
+                   new Archive::Entry(this, QStringLiteral("dir/sub/b.txt"))
+               }
+            << QStringList {
+                   QStringLiteral("dir"),
+                   QStringLiteral("dir/a.txt"),
+                   QStringLiteral("dir/sub"),
+                   QStringLiteral("dir/sub/b.txt")
+               };
+
+    QTest::newRow("selected directory only")
+            << QVector<Archive::Entry*> {
+                   new Archive::Entry(this, QStringLiteral("dir/sub/"))
+               }
+            << QStringList {
+                   QStringLiteral("dir"),
+                   QStringLiteral("dir/sub")
+               };
+}
+
+void LibzipTest::testExtractDirectoriesWithoutRecords()
+{
+    auto archive = TestHelper::loadArchive(QFINDTESTDATA("data/nodirrecords.zip"), QStringLiteral("kerfuffle_libzip"), this);
+    if (!archive) {
+        QSKIP("libzip plugin not available. Skipping test.", SkipSingle);
+    }
+
+    QTemporaryDir destDir;
+    if (!destDir.isValid()) {
+        QSKIP("Could not create a temporary directory for extraction. Skipping test.", SkipSingle);
+    }
+
+    QFETCH(QVector<Archive::Entry*>, entriesToExtract);
+    auto extractionJob = archive->extractFiles(entriesToExtract, destDir.path());
+    QVERIFY(extractionJob);
+    extractionJob->setAutoDelete(false);
+    TestHelper::startAndWaitForResult(extractionJob);
+    QCOMPARE(extractionJob->error(), int(KJob::NoError));
+
+    QStringList extractedEntries;
+    QDirIterator dirIt(destDir.path(), QDir::AllEntries | QDir::Hidden | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+    while (dirIt.hasNext()) {
+        extractedEntries << QDir(destDir.path()).relativeFilePath(dirIt.next());
+    }
+    extractedEntries.sort();
+
+    QFETCH(QStringList, expectedExtractedEntries);
+    QCOMPARE(extractedEntries, expectedExtractedEntries);
+
+    extractionJob->deleteLater();
+    archive->deleteLater();
+}
+
+void LibzipTest::testParallelCompression_data()
+{
+    QTest::addColumn<int>("numberOfThreads");
+    QTest::addColumn<QVector<int> >("fileSizes");
+
+    QTest::newRow("single thread")
+            << 1
+            << QVector<int> {0, 100, 3 * 1024 * 1024};
+
+    // More files than the threads may compress ahead of zip_close().
+    QTest::newRow("small files")
+            << 4
+            << QVector<int>(20, 10 * 1024);
+
+    // The compressed data of the large files does not fit in memory and is spilled.
+    QTest::newRow("small and large files")
+            << 4
+            << QVector<int> {0, 5 * 1024 * 1024, 100, 3 * 1024 * 1024, 10 * 1024, 4 * 1024 * 1024, 1};
+}
+
+void LibzipTest::testParallelCompression()
+{
+    QTemporaryDir sourceDir;
+    QTemporaryDir archiveDir;
+    QTemporaryDir destDir;
+    if (!sourceDir.isValid() || !archiveDir.isValid() || !destDir.isValid()) {
+        QSKIP("Could not create the temporary directories. Skipping test.", SkipSingle);
+    }
+
+    QFETCH(QVector<int>, fileSizes);
+    QVector<QByteArray> contents;
+    QVector<Archive::Entry*> entries;
+    for (int i = 0; i < fileSizes.size(); i++) {
+        contents << testData(fileSizes.at(i), i);
+        QFile file(sourceDir.path() + QStringLiteral("/file%1.txt").arg(i));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        QCOMPARE(file.write(contents.last()), qint64(contents.last().size()));
+        entries << new Archive::Entry(this, file.fileName());
+    }
+
+    const QString archivePath = archiveDir.path() + QStringLiteral("/test.zip");
+    auto archive = Archive::createEmpty(archivePath, QStringLiteral("application/zip"), this);
+    QVERIFY(archive);
+    if (!archive->isValid() || !archive->interface()->inherits("LibzipPlugin")) {
+        QSKIP("libzip plugin not available. Skipping test.", SkipSingle);
+    }
+
+    QFETCH(int, numberOfThreads);
+    CompressionOptions options;
+    options.setGlobalWorkDir(sourceDir.path());
+    options.setNumberOfThreads(numberOfThreads);
+    AddJob *addJob = archive->addFiles(entries, nullptr, options);
+    QVERIFY(addJob);
+    TestHelper::startAndWaitForResult(addJob);
+    QCOMPARE(archive->numberOfEntries(), uint(fileSizes.size()));
+
+    // The spill files next to the archive are removed once written.
+    QCOMPARE(QDir(archiveDir.path()).entryList(QDir::Files | QDir::Hidden), QStringList {QStringLiteral("test.zip")});
+
+    // Load the archive again, so that the CRCs are checked against the written data.
+    auto loadedArchive = TestHelper::loadArchive(archivePath, QStringLiteral("kerfuffle_libzip"), this);
+    QVERIFY(loadedArchive);
+
+    TestJob *testJob = TestHelper::testArchive(loadedArchive);
+    QVERIFY(testJob->testSucceeded());
+
+    auto extractionJob = loadedArchive->extractFiles({}, destDir.path());
+    QVERIFY(extractionJob);
+    extractionJob->setAutoDelete(false);
+    TestHelper::startAndWaitForResult(extractionJob);
+
+    for (int i = 0; i < contents.size(); i++) {
+        QFile file(destDir.path() + QStringLiteral("/file%1.txt").arg(i));
+        QVERIFY2(file.open(QIODevice::ReadOnly), qPrintable(file.fileName()));
+        QVERIFY2(file.readAll() == contents.at(i), qPrintable(file.fileName()));
+    }
+
+    extractionJob->deleteLater();
+    testJob->deleteLater();
+    loadedArchive->deleteLater();
+    archive->deleteLater();
+}
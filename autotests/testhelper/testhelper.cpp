@@ -25,6 +25,9 @@
  */
 
 #include "testhelper.h"
+#include "archive_kerfuffle.h"
+#include "jobs.h"
+#include "pluginmanager.h"
 
 #include <KJob>
 
@@ -38,6 +41,40 @@ void TestHelper::startAndWaitForResult(KJob *job)
     eventLoop.exec(); // krazy:exclude=crashy
 }
 
+Kerfuffle::Archive *TestHelper::loadArchive(const QString &archivePath, const QString &pluginId, QObject *parent)
+{
+    Kerfuffle::PluginManager pluginManager;
+    Kerfuffle::Plugin *plugin = nullptr;
+    foreach (Kerfuffle::Plugin *availablePlugin, pluginManager.availablePlugins()) {
+        if (availablePlugin->metaData().pluginId() == pluginId) {
+            plugin = availablePlugin;
+        }
+    }
+    if (!plugin || !plugin->isValid()) {
+        return nullptr;
+    }
+
+    auto loadJob = Kerfuffle::Archive::load(archivePath, plugin, parent);
+    loadJob->setAutoDelete(false);
+    startAndWaitForResult(loadJob);
+
+    auto archive = loadJob->archive();
+    loadJob->deleteLater();
+    if (!archive->isValid()) {
+        archive->deleteLater();
+        return nullptr;
+    }
+    return archive;
+}
+
+Kerfuffle::TestJob *TestHelper::testArchive(Kerfuffle::Archive *archive)
+{
+    auto testJob = archive->testArchive();
+    testJob->setAutoDelete(false);
+    startAndWaitForResult(testJob);
+    return testJob;
+}
+
 
 QStringList TestHelper::testFormats()
 {
@@ -28,6 +28,13 @@
 #define TESTHELPER_H
 
 class KJob;
+class QObject;
+
+namespace Kerfuffle
+{
+    class Archive;
+    class TestJob;
+}
 
 #include <QStringList>
 
@@ -35,6 +42,18 @@ namespace TestHelper
 {
     void startAndWaitForResult(KJob *job);
 
+    /**
+     * Loads @p archivePath with the plugin whose id is @p pluginId.
+     * @return The loaded archive, or nullptr if the plugin is not available or could not be loaded.
+     */
+    Kerfuffle::Archive *loadArchive(const QString &archivePath, const QString &pluginId, QObject *parent = nullptr);
+
+    /**
+     * Tests @p archive and waits for the result.
+     * @return The finished job, to be deleted by the caller.
+     */
+    Kerfuffle::TestJob *testArchive(Kerfuffle::Archive *archive);
+
     /**
      * @return List of format extensions (without the leading dot) to be used in tests.
      */
@@ -88,6 +88,16 @@ void AddToArchive::setHeaderEncryptionEnabled(bool enabled)
     m_enableHeaderEncryption = enabled;
 }
 
+void AddToArchive::setNumberOfThreads(int threads)
+{
+    m_options.setNumberOfThreads(threads);
+}
+
+void AddToArchive::setCompressionMethod(const QString &method)
+{
+    m_options.setCompressionMethod(method);
+}
+
 bool AddToArchive::showAddDialog()
 {
     qCDebug(ARK) << "Opening add dialog";
@@ -110,6 +120,7 @@ bool AddToArchive::showAddDialog()
         m_options.setCompressionMethod(dialog.data()->compressionMethod());
         m_options.setEncryptionMethod(dialog.data()->encryptionMethod());
         m_options.setVolumeSize(dialog.data()->volumeSize());
+        m_options.setNumberOfThreads(dialog.data()->numberOfThreads());
     }
 
     delete dialog.data();
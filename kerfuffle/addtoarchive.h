@@ -70,6 +70,8 @@ public slots:
     void setMimeType(const QString & mimeType);
     void setPassword(const QString &password);
     void setHeaderEncryptionEnabled(bool enabled);
+    void setNumberOfThreads(int threads);
+    void setCompressionMethod(const QString &method);
     void start() override;
 
 protected:
@@ -25,12 +25,56 @@
 
 #include "archiveentry.h"
 
+#include <QMutex>
+#include <QSet>
+
 namespace Kerfuffle {
+
+namespace {
+
+class StringPool
+{
+public:
+    QString intern(const QString &string)
+    {
+        if (string.isEmpty()) {
+            return QString();
+        }
+
+        QMutexLocker locker(&m_mutex);
+        auto it = m_strings.constFind(string);
+        if (it != m_strings.constEnd()) {
+            return *it;
+        }
+        // Don't let high-cardinality values (e.g. unusual permission
+        // strings on every entry) grow the pool without bounds.
+        if (m_strings.size() < maxSize) {
+            m_strings.insert(string);
+        }
+        return string;
+    }
+
+private:
+    static const int maxSize = 4096;
+
+    QMutex m_mutex;
+    QSet<QString> m_strings;
+};
+
+Q_GLOBAL_STATIC(StringPool, s_stringPool)
+
+// Directories with fewer children than this are searched linearly,
+// which is faster than hashing for small sizes.
+const int childIndexThreshold = 32;
+
+}
+
 Archive::Entry::Entry(QObject *parent, const QString &fullPath, const QString &rootNode)
     : QObject(parent)
     , rootNode(rootNode)
     , compressedSizeIsSet(true)
     , m_parent(qobject_cast<Entry*>(parent))
+    , m_row(-1)
     , m_size(0)
     , m_compressedSize(0)
     , m_isDirectory(false)
@@ -46,20 +90,22 @@ Archive::Entry::~Entry()
 
 void Archive::Entry::copyMetaData(const Archive::Entry *sourceEntry)
 {
-    setProperty("fullPath", sourceEntry->property("fullPath"));
-    setProperty("permissions", sourceEntry->property("permissions"));
-    setProperty("owner", sourceEntry->property("owner"));
-    setProperty("group", sourceEntry->property("group"));
-    setProperty("size", sourceEntry->property("size"));
-    setProperty("compressedSize", sourceEntry->property("compressedSize"));
-    setProperty("link", sourceEntry->property("link"));
-    setProperty("ratio", sourceEntry->property("ratio"));
-    setProperty("CRC", sourceEntry->property("CRC"));
-    setProperty("method", sourceEntry->property("method"));
-    setProperty("version", sourceEntry->property("version"));
-    setProperty("timestamp", sourceEntry->property("timestamp").toDateTime());
-    setProperty("isDirectory", sourceEntry->property("isDirectory"));
-    setProperty("isPasswordProtected", sourceEntry->property("isPasswordProtected"));
+    // Copy the members directly instead of going through the meta-object
+    // system: this is called for every entry of an archive being loaded.
+    setFullPath(sourceEntry->m_fullPath);
+    m_permissions = sourceEntry->m_permissions;
+    m_owner = sourceEntry->m_owner;
+    m_group = sourceEntry->m_group;
+    m_size = sourceEntry->m_size;
+    m_compressedSize = sourceEntry->m_compressedSize;
+    m_link = sourceEntry->m_link;
+    m_ratio = sourceEntry->m_ratio;
+    m_CRC = sourceEntry->m_CRC;
+    m_method = sourceEntry->m_method;
+    m_version = sourceEntry->m_version;
+    m_timestamp = sourceEntry->m_timestamp;
+    setIsDirectory(sourceEntry->m_isDirectory);
+    m_isPasswordProtected = sourceEntry->m_isPasswordProtected;
 }
 
 QVector<Archive::Entry*> Archive::Entry::entries()
@@ -77,20 +123,48 @@ void Archive::Entry::setEntryAt(int index, Entry *value)
 {
     Q_ASSERT(isDir());
     Q_ASSERT(index < m_entries.count());
+    if (m_entries.at(index)) {
+        m_entries.at(index)->m_row = -1;
+    }
     m_entries[index] = value;
+    if (value) {
+        value->m_row = index;
+    }
+    // The index must return the first entry with a given name, rebuild it
+    // when needed rather than trying to preserve the order here.
+    m_entriesIndex.clear();
 }
 
 void Archive::Entry::appendEntry(Entry *entry)
 {
     Q_ASSERT(isDir());
+    if (entry) {
+        entry->m_row = m_entries.count();
+    }
     m_entries.append(entry);
+    if (!m_entriesIndex.isEmpty()) {
+        m_entriesIndex.insert(entry->name(), entry);
+    }
 }
 
 void Archive::Entry::removeEntryAt(int index)
 {
     Q_ASSERT(isDir());
     Q_ASSERT(index < m_entries.count());
+    Entry *entry = m_entries.at(index);
     m_entries.remove(index);
+    if (entry) {
+        entry->m_row = -1;
+    }
+    // Shift the position of the following siblings.
+    for (int i = index; i < m_entries.count(); ++i) {
+        if (m_entries.at(i)) {
+            m_entries.at(i)->m_row = i;
+        }
+    }
+    if (entry && !m_entriesIndex.isEmpty()) {
+        m_entriesIndex.remove(entry->name(), entry);
+    }
 }
 
 Archive::Entry *Archive::Entry::getParent() const
@@ -105,9 +179,22 @@ void Archive::Entry::setParent(Archive::Entry *parent)
 
 void Archive::Entry::setFullPath(const QString &fullPath)
 {
+    const QString oldName = m_name;
     m_fullPath = fullPath;
-    const QStringList pieces = m_fullPath.split(QLatin1Char('/'), QString::SkipEmptyParts);
-    m_name = pieces.isEmpty() ? QString() : pieces.last();
+
+    // Same as the last non-empty piece of the path split on '/', without
+    // building a temporary list for every entry.
+    int end = m_fullPath.size();
+    while (end > 0 && m_fullPath.at(end - 1) == QLatin1Char('/')) {
+        --end;
+    }
+    const int start = m_fullPath.lastIndexOf(QLatin1Char('/'), end - 1) + 1;
+    m_name = (end == 0) ? QString() : m_fullPath.mid(start, end - start);
+
+    // Keep the parent's index in sync when the entry gets renamed.
+    if (m_parent && m_name != oldName && m_parent->m_entriesIndex.remove(oldName, this) > 0) {
+        m_parent->m_entriesIndex.insert(m_name, this);
+    }
 }
 
 QString Archive::Entry::fullPath(PathFormat format) const
@@ -129,6 +216,36 @@ void Archive::Entry::setIsDirectory(const bool isDirectory)
     m_isDirectory = isDirectory;
 }
 
+void Archive::Entry::setPermissions(const QString &permissions)
+{
+    m_permissions = intern(permissions);
+}
+
+void Archive::Entry::setOwner(const QString &owner)
+{
+    m_owner = intern(owner);
+}
+
+void Archive::Entry::setGroup(const QString &group)
+{
+    m_group = intern(group);
+}
+
+void Archive::Entry::setRatio(const QString &ratio)
+{
+    m_ratio = intern(ratio);
+}
+
+void Archive::Entry::setMethod(const QString &method)
+{
+    m_method = intern(method);
+}
+
+void Archive::Entry::setVersion(const QString &version)
+{
+    m_version = intern(version);
+}
+
 bool Archive::Entry::isDir() const
 {
     return m_isDirectory;
@@ -137,19 +254,38 @@ bool Archive::Entry::isDir() const
 int Archive::Entry::row() const
 {
     if (getParent()) {
-        return getParent()->entries().indexOf(const_cast<Archive::Entry*>(this));
+        return m_row;
     }
     return 0;
 }
 
 Archive::Entry *Archive::Entry::find(const QString &name) const
 {
-    foreach (Entry *entry, m_entries) {
-        if (entry && (entry->name() == name)) {
-            return entry;
+    if (m_entriesIndex.isEmpty()) {
+        if (m_entries.count() < childIndexThreshold) {
+            foreach (Entry *entry, m_entries) {
+                if (entry && (entry->name() == name)) {
+                    return entry;
+                }
+            }
+            return nullptr;
+        }
+
+        m_entriesIndex.reserve(m_entries.count());
+        foreach (Entry *entry, m_entries) {
+            if (entry) {
+                m_entriesIndex.insert(entry->name(), entry);
+            }
         }
     }
-    return nullptr;
+
+    // Values with the same key are iterated from the most recently inserted
+    // one, so the last one is the first child with this name.
+    Entry *match = nullptr;
+    for (auto it = m_entriesIndex.constFind(name); it != m_entriesIndex.constEnd() && it.key() == name; ++it) {
+        match = it.value();
+    }
+    return match;
 }
 
 Archive::Entry *Archive::Entry::findByPath(const QStringList &pieces, int index) const
@@ -189,6 +325,11 @@ bool Archive::Entry::operator==(const Archive::Entry &right) const
     return m_fullPath == right.m_fullPath;
 }
 
+QString Archive::Entry::intern(const QString &string)
+{
+    return s_stringPool->intern(string);
+}
+
 QDebug operator<<(QDebug d, const Kerfuffle::Archive::Entry &entry)
 {
     d.nospace() << "Entry(" << entry.property("fullPath");
@@ -29,6 +29,7 @@
 #include "archive_kerfuffle.h"
 
 #include <QDateTime>
+#include <QMultiHash>
 
 #include <KIconLoader>
 
@@ -55,16 +56,16 @@ class Archive::Entry : public QObject
      */
     Q_PROPERTY(QString fullPath MEMBER m_fullPath WRITE setFullPath)
     Q_PROPERTY(QString name READ name)
-    Q_PROPERTY(QString permissions MEMBER m_permissions)
-    Q_PROPERTY(QString owner MEMBER m_owner)
-    Q_PROPERTY(QString group MEMBER m_group)
+    Q_PROPERTY(QString permissions MEMBER m_permissions WRITE setPermissions)
+    Q_PROPERTY(QString owner MEMBER m_owner WRITE setOwner)
+    Q_PROPERTY(QString group MEMBER m_group WRITE setGroup)
     Q_PROPERTY(qulonglong size MEMBER m_size)
     Q_PROPERTY(qulonglong compressedSize MEMBER m_compressedSize)
     Q_PROPERTY(QString link MEMBER m_link)
-    Q_PROPERTY(QString ratio MEMBER m_ratio)
+    Q_PROPERTY(QString ratio MEMBER m_ratio WRITE setRatio)
     Q_PROPERTY(QString CRC MEMBER m_CRC)
-    Q_PROPERTY(QString method MEMBER m_method)
-    Q_PROPERTY(QString version MEMBER m_version)
+    Q_PROPERTY(QString method MEMBER m_method WRITE setMethod)
+    Q_PROPERTY(QString version MEMBER m_version WRITE setVersion)
     Q_PROPERTY(QDateTime timestamp MEMBER m_timestamp)
     Q_PROPERTY(bool isDirectory MEMBER m_isDirectory WRITE setIsDirectory)
     Q_PROPERTY(bool isPasswordProtected MEMBER m_isPasswordProtected)
@@ -87,8 +88,36 @@ public:
     QString fullPath(PathFormat format = WithTrailingSlash) const;
     QString name() const;
     void setIsDirectory(const bool isDirectory);
+
+    /**
+     * Setters for metadata that usually takes only a few distinct values
+     * in a whole archive. The strings are shared between all the entries
+     * with the same value, so that large archives don't pay for one copy
+     * per entry.
+     */
+    void setPermissions(const QString &permissions);
+    void setOwner(const QString &owner);
+    void setGroup(const QString &group);
+    void setRatio(const QString &ratio);
+    void setMethod(const QString &method);
+    void setVersion(const QString &version);
+
     bool isDir() const;
+
+    /**
+     * @return The position of the entry among its parent's children.
+     * The position is stored in the entry and kept up to date by the parent,
+     * so this does not depend on the number of siblings.
+     */
     int row() const;
+
+    /**
+     * @return The first child entry called @p name, or nullptr if there is none.
+     *
+     * Directories with many children keep a hash of their children's names,
+     * built the first time they are searched, so the lookup cost does not
+     * depend on the number of children.
+     */
     Entry *find(const QString &name) const;
     Entry *findByPath(const QStringList & pieces, int index = 0) const;
 
@@ -108,6 +137,11 @@ private:
     QVector<Entry*> m_entries;
     QString         m_name;
     Entry           *m_parent;
+    int             m_row;
+
+    // Children indexed by name. Empty until the directory is searched while
+    // having more than a few children.
+    mutable QMultiHash<QString, Entry*> m_entriesIndex;
 
     QString m_fullPath;
     QString m_permissions;
@@ -123,6 +157,12 @@ private:
     QDateTime m_timestamp;
     bool m_isDirectory;
     bool m_isPasswordProtected;
+
+    /**
+     * @return A copy of @p string sharing its data with every other
+     * interned string with the same value.
+     */
+    static QString intern(const QString &string);
 };
 
 QDebug KERFUFFLE_EXPORT operator<<(QDebug d, const Kerfuffle::Archive::Entry &entry);
@@ -43,6 +43,7 @@ ArchiveFormat::ArchiveFormat(const QMimeType& mimeType,
                              bool supportsWriteComment,
                              bool supportsTesting,
                              bool supportsMultiVolume,
+                             bool supportsMultithreading,
                              const QVariantMap& compressionMethods,
                              const QString& defaultCompressionMethod,
                              const QStringList &encryptionMethods,
@@ -55,6 +56,7 @@ ArchiveFormat::ArchiveFormat(const QMimeType& mimeType,
     m_supportsWriteComment(supportsWriteComment),
     m_supportsTesting(supportsTesting),
     m_supportsMultiVolume(supportsMultiVolume),
+    m_supportsMultithreading(supportsMultithreading),
     m_compressionMethods(compressionMethods),
     m_defaultCompressionMethod(defaultCompressionMethod),
     m_encryptionMethods(encryptionMethods),
@@ -79,6 +81,7 @@ ArchiveFormat ArchiveFormat::fromMetadata(const QMimeType& mimeType, const KPlug
         bool supportsWriteComment = formatProps[QStringLiteral("SupportsWriteComment")].toBool();
         bool supportsTesting = formatProps[QStringLiteral("SupportsTesting")].toBool();
         bool supportsMultiVolume = formatProps[QStringLiteral("SupportsMultiVolume")].toBool();
+        bool supportsMultithreading = formatProps[QStringLiteral("SupportsMultithreading")].toBool();
 
         QVariantMap compressionMethods = formatProps[QStringLiteral("CompressionMethods")].toObject().toVariantMap();
         QString defaultCompMethod = formatProps[QStringLiteral("CompressionMethodDefault")].toString();
@@ -107,6 +110,7 @@ ArchiveFormat ArchiveFormat::fromMetadata(const QMimeType& mimeType, const KPlug
                              supportsWriteComment,
                              supportsTesting,
                              supportsMultiVolume,
+                             supportsMultithreading,
                              compressionMethods,
                              defaultCompMethod,
                              encryptionMethods,
@@ -156,6 +160,11 @@ bool ArchiveFormat::supportsMultiVolume() const
     return m_supportsMultiVolume;
 }
 
+bool ArchiveFormat::supportsMultithreading() const
+{
+    return m_supportsMultithreading;
+}
+
 QVariantMap ArchiveFormat::compressionMethods() const
 {
     return m_compressionMethods;
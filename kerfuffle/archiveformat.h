@@ -45,6 +45,7 @@ public:
                            bool supportsWriteComment,
                            bool supportsTesting,
                            bool suppportsMultiVolume,
+                           bool supportsMultithreading,
                            const QVariantMap& compressionMethods,
                            const QString& defaultCompressionMethod,
                            const QStringList &encryptionMethods,
@@ -71,6 +72,7 @@ public:
     bool supportsWriteComment() const;
     bool supportsTesting() const;
     bool supportsMultiVolume() const;
+    bool supportsMultithreading() const;
     QVariantMap compressionMethods() const;
     QString defaultCompressionMethod() const;
     QStringList encryptionMethods() const;
@@ -85,6 +87,7 @@ private:
     bool m_supportsWriteComment = false;
     bool m_supportsTesting = false;
     bool m_supportsMultiVolume = false;
+    bool m_supportsMultithreading = false;
     QVariantMap m_compressionMethods;
     QString m_defaultCompressionMethod;
     QStringList m_encryptionMethods;
@@ -51,6 +51,7 @@ ReadOnlyArchiveInterface::ReadOnlyArchiveInterface(QObject *parent, const QVaria
     m_filename = args.first().toString();
     m_mimetype = determineMimeType(m_filename);
     connect(this, &ReadOnlyArchiveInterface::entry, this, &ReadOnlyArchiveInterface::onEntry);
+    connect(this, &ReadOnlyArchiveInterface::entriesBatch, this, &ReadOnlyArchiveInterface::onEntriesBatch);
     m_metaData = args.at(1).value<KPluginMetaData>();
 }
 
@@ -64,6 +65,39 @@ void ReadOnlyArchiveInterface::onEntry(Archive::Entry *archiveEntry)
     m_numberOfEntries++;
 }
 
+void ReadOnlyArchiveInterface::onEntriesBatch(const QVector<Archive::Entry*> &entries)
+{
+    m_numberOfEntries += entries.count();
+}
+
+void ReadOnlyArchiveInterface::queueEntry(Archive::Entry *entry)
+{
+    // Send the entries either when enough of them have been collected,
+    // or when the last batch is old enough for the GUI to look stuck.
+    const int maxBatchSize = 1000;
+    const qint64 maxBatchInterval = 100;
+
+    if (m_queuedEntries.isEmpty()) {
+        m_queuedEntries.reserve(maxBatchSize);
+        m_queuedEntriesTimer.start();
+    }
+    m_queuedEntries << entry;
+
+    if (m_queuedEntries.count() >= maxBatchSize || m_queuedEntriesTimer.elapsed() >= maxBatchInterval) {
+        flushEntries();
+    }
+}
+
+void ReadOnlyArchiveInterface::flushEntries()
+{
+    if (m_queuedEntries.isEmpty()) {
+        return;
+    }
+
+    emit entriesBatch(m_queuedEntries);
+    m_queuedEntries.clear();
+}
+
 QString ReadOnlyArchiveInterface::filename() const
 {
     return m_filename;
@@ -159,6 +193,27 @@ ReadWriteArchiveInterface::~ReadWriteArchiveInterface()
 {
 }
 
+void ReadWriteArchiveInterface::setFileManifest(const FileManifest &manifest)
+{
+    m_fileManifest = manifest;
+}
+
+FileManifest ReadWriteArchiveInterface::takeFileManifest(const QVector<Archive::Entry*> &files)
+{
+    if (m_fileManifest.isEmpty()) {
+        QStringList paths;
+        paths.reserve(files.size());
+        foreach (const Archive::Entry *file, files) {
+            paths << file->fullPath();
+        }
+        return FileManifest::scan(paths);
+    }
+
+    const FileManifest manifest = m_fileManifest;
+    m_fileManifest = FileManifest();
+    return manifest;
+}
+
 bool ReadOnlyArchiveInterface::waitForFinishedSignal()
 {
     return m_waitForFinishedSignal;
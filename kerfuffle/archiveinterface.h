@@ -32,7 +32,9 @@
 #include "archive_kerfuffle.h"
 #include "kerfuffle_export.h"
 #include "archiveentry.h"
+#include "filemanifest.h"
 
+#include <QElapsedTimer>
 #include <QObject>
 #include <QStringList>
 #include <QString>
@@ -163,14 +165,32 @@ public:
      */
     virtual bool hasBatchExtractionProgress() const;
 
+    /**
+     * Emits entriesBatch() with the entries queued by queueEntry() so far, if any.
+     * Jobs call this once the operation returned, in case it failed before
+     * flushing the queued entries itself.
+     */
+    void flushEntries();
+
 signals:
     void cancelled();
     void error(const QString &message, const QString &details = QString());
     void entry(Archive::Entry *archiveEntry);
+
+    /**
+     * Emitted with the entries queued by queueEntry().
+     */
+    void entriesBatch(const QVector<Archive::Entry*> &entries);
     void progress(double progress);
     void info(const QString &info);
     void finished(bool result);
     void testSuccess();
+
+    /**
+     * Emitted by plugins which test every entry, for each entry that failed
+     * the test. @p reason describes the problem, for example a CRC error.
+     */
+    void testFailure(const QString &entry, const QString &reason);
     void compressionMethodFound(const QString &method);
     void encryptionMethodFound(const QString &method);
 
@@ -189,6 +209,17 @@ protected:
 
     void setCorrupt(bool isCorrupt);
     bool isCorrupt() const;
+
+    /**
+     * Queues @p entry to be emitted with the next entriesBatch() signal.
+     * Plugins running in their own thread should prefer this over emitting
+     * entry() for every entry, since each signal has to go through the event
+     * loop of the GUI thread.
+     *
+     * @note flushEntries() must be called before the operation returns.
+     */
+    void queueEntry(Archive::Entry *entry);
+
     QString m_comment;
     int m_numberOfVolumes;
     uint m_numberOfEntries;
@@ -202,9 +233,12 @@ private:
     bool m_isHeaderEncryptionEnabled;
     bool m_isCorrupt;
     bool m_isMultiVolume;
+    QVector<Archive::Entry*> m_queuedEntries;
+    QElapsedTimer m_queuedEntriesTimer;
 
 private slots:
     void onEntry(Archive::Entry *archiveEntry);
+    void onEntriesBatch(const QVector<Archive::Entry*> &entries);
 };
 
 class KERFUFFLE_EXPORT ReadWriteArchiveInterface: public ReadOnlyArchiveInterface
@@ -226,9 +260,25 @@ public:
     virtual bool deleteFiles(const QVector<Archive::Entry*> &files) = 0;
     virtual bool addComment(const QString &comment) = 0;
 
+    /**
+     * Sets the files found on disk for the next addFiles() call, so that
+     * plugins do not have to scan the added directories again.
+     */
+    void setFileManifest(const FileManifest &manifest);
+
 signals:
     void entryRemoved(const QString &path);
 
+protected:
+    /**
+     * @return The manifest set with setFileManifest(), or a new one scanned
+     * from @p files if none was set. The stored manifest is released.
+     */
+    FileManifest takeFileManifest(const QVector<Archive::Entry*> &files);
+
+private:
+    FileManifest m_fileManifest;
+
 private slots:
     void onEntryRemoved(const QString &path);
 };
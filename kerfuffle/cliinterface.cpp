@@ -31,9 +31,8 @@
 #include "ark_debug.h"
 #include "queries.h"
 
-#ifdef Q_OS_WIN
-# include <KProcess>
-#else
+#include <KProcess>
+#ifndef Q_OS_WIN
 # include <KPtyDevice>
 # include <KPtyProcess>
 #endif
@@ -117,14 +116,16 @@ bool CliInterface::extractFiles(const QVector<Archive::Entry*> &files, const QSt
         }
     }
 
-    QUrl destDir = QUrl(destinationDirectory);
-    QDir::setCurrent(destDir.adjusted(QUrl::RemoveScheme).url());
+    // The program extracts to its working directory. The process-wide current
+    // directory is left alone, since several jobs can run at the same time.
+    QString workingDirectory = QDir(QUrl(destinationDirectory).adjusted(QUrl::RemoveScheme).url()).absolutePath();
 
     const bool useTmpExtractDir = options.isDragAndDropEnabled() || options.alwaysUseTempDir();
 
     if (useTmpExtractDir) {
-        // Create an hidden temp folder in the current directory.
-        m_extractTempDir.reset(new QTemporaryDir(QStringLiteral(".%1-").arg(QCoreApplication::applicationName())));
+        // Create an hidden temp folder in the destination directory.
+        m_extractTempDir.reset(new QTemporaryDir(workingDirectory + QLatin1Char('/') +
+                                                 QStringLiteral(".%1-").arg(QCoreApplication::applicationName())));
 
         qCDebug(ARK) << "Using temporary extraction dir:" << m_extractTempDir->path();
         if (!m_extractTempDir->isValid()) {
@@ -132,16 +133,15 @@ bool CliInterface::extractFiles(const QVector<Archive::Entry*> &files, const QSt
             emit finished(false);
             return false;
         }
-        m_oldWorkingDir = QDir::currentPath();
-        destDir = QUrl(m_extractTempDir->path());
-        QDir::setCurrent(destDir.adjusted(QUrl::RemoveScheme).url());
+        workingDirectory = m_extractTempDir->path();
     }
 
     return runProcess(m_cliProps->property("extractProgram").toString(),
                     m_cliProps->extractArgs(filename(),
                                             extractFilesList(files),
                                             options.preservePaths(),
-                                            password()));
+                                            password()),
+                    workingDirectory);
 }
 
 bool CliInterface::addFiles(const QVector<Archive::Entry*> &files, const Archive::Entry *destination, const CompressionOptions& options, uint numberOfEntriesToAdd)
@@ -159,6 +159,10 @@ bool CliInterface::addFiles(const QVector<Archive::Entry*> &files, const Archive
 
     qCDebug(ARK) << "Adding" << files.count() << "file(s) to destination:" << destinationPath;
 
+    // The files are relative to the directory set by the job, or to the
+    // temporary directory filled by a copy or a move.
+    QString workingDirectory = m_tempAddDir ? m_tempAddDir->path() : QDir::currentPath();
+
     if (!destinationPath.isEmpty()) {
         m_extractTempDir.reset(new QTemporaryDir());
         const QString absoluteDestinationPath = m_extractTempDir->path() + QLatin1Char('/') + destinationPath;
@@ -174,7 +178,7 @@ bool CliInterface::addFiles(const QVector<Archive::Entry*> &files, const Archive
                 preservedParent = file->parent();
             }
 
-            const QString filePath = QDir::currentPath() + QLatin1Char('/') + file->fullPath(NoTrailingSlash);
+            const QString filePath = workingDirectory + QLatin1Char('/') + file->fullPath(NoTrailingSlash);
             const QString newFilePath = absoluteDestinationPath + file->fullPath(NoTrailingSlash);
             if (QFile::link(filePath, newFilePath)) {
                 qCDebug(ARK) << "Symlink's created:" << filePath << newFilePath;
@@ -185,8 +189,7 @@ bool CliInterface::addFiles(const QVector<Archive::Entry*> &files, const Archive
             }
         }
 
-        qCDebug(ARK) << "Changing working dir again to " << m_extractTempDir->path();
-        QDir::setCurrent(m_extractTempDir->path());
+        workingDirectory = m_extractTempDir->path();
 
         filesToPass.push_back(new Archive::Entry(preservedParent, destinationPath.split(QLatin1Char('/'), QString::SkipEmptyParts).at(0)));
     } else {
@@ -208,7 +211,8 @@ bool CliInterface::addFiles(const QVector<Archive::Entry*> &files, const Archive
                                           options.compressionLevel(),
                                           options.compressionMethod(),
                                           options.encryptionMethod(),
-                                          options.volumeSize()));
+                                          options.volumeSize()),
+                      workingDirectory);
 }
 
 bool CliInterface::moveFiles(const QVector<Archive::Entry*> &files, Archive::Entry *destination, const CompressionOptions &options)
@@ -230,10 +234,8 @@ bool CliInterface::moveFiles(const QVector<Archive::Entry*> &files, Archive::Ent
 
 bool CliInterface::copyFiles(const QVector<Archive::Entry*> &files, Archive::Entry *destination, const CompressionOptions &options)
 {
-    m_oldWorkingDir = QDir::currentPath();
     m_tempWorkingDir.reset(new QTemporaryDir());
     m_tempAddDir.reset(new QTemporaryDir());
-    QDir::setCurrent(m_tempWorkingDir->path());
     m_passedFiles = files;
     m_passedDestination = destination;
     m_passedOptions = options;
@@ -242,7 +244,7 @@ bool CliInterface::copyFiles(const QVector<Archive::Entry*> &files, Archive::Ent
     m_subOperation = Extract;
     connect(this, &CliInterface::finished, this, &CliInterface::continueCopying);
 
-    return extractFiles(files, QDir::currentPath(), ExtractionOptions());
+    return extractFiles(files, m_tempWorkingDir->path(), ExtractionOptions());
 }
 
 bool CliInterface::deleteFiles(const QVector<Archive::Entry*> &files)
@@ -263,7 +265,7 @@ bool CliInterface::testArchive()
     return runProcess(m_cliProps->property("testProgram").toString(), m_cliProps->testArgs(filename(), password()));
 }
 
-bool CliInterface::runProcess(const QString& programName, const QStringList& arguments)
+bool CliInterface::runProcess(const QString& programName, const QStringList& arguments, const QString &workingDirectory)
 {
     Q_ASSERT(!m_process);
 
@@ -274,18 +276,38 @@ bool CliInterface::runProcess(const QString& programName, const QStringList& arg
         return false;
     }
 
-    qCDebug(ARK) << "Executing" << programPath << arguments << "within directory" << QDir::currentPath();
+    qCDebug(ARK) << "Executing" << programPath << arguments << "within directory"
+                 << (workingDirectory.isEmpty() ? QDir::currentPath() : workingDirectory);
+
+    m_programName = programName;
+    m_programArguments = arguments;
+    m_workingDirectory = workingDirectory;
 
 #ifdef Q_OS_WIN
     m_process = new KProcess;
+    m_process->setNextOpenMode(QIODevice::ReadWrite | QIODevice::Unbuffered | QIODevice::Text);
 #else
-    m_process = new KPtyProcess;
-    m_process->setPtyChannels(KPtyProcess::StdinChannel);
+    if (m_forceInteractiveInput || needsInteractiveInput()) {
+        KPtyProcess *ptyProcess = new KPtyProcess;
+        ptyProcess->setPtyChannels(KPtyProcess::StdinChannel);
+        ptyProcess->setNextOpenMode(QIODevice::ReadWrite | QIODevice::Unbuffered | QIODevice::Text);
+        m_process = ptyProcess;
+    } else {
+        // Nothing will be written to the process, so it doesn't need a terminal.
+        // An unexpected prompt reads EOF instead of blocking forever, and
+        // handleLine() restarts the process if it can be answered.
+        m_process = new KProcess;
+        m_process->setStandardInputFile(QProcess::nullDevice());
+        m_process->setNextOpenMode(QIODevice::ReadOnly | QIODevice::Text);
+    }
 #endif
+    qCDebug(ARK) << "Using a pseudo-terminal:" << bool(qobject_cast<KPtyProcess*>(m_process));
 
     m_process->setOutputChannelMode(KProcess::MergedChannels);
-    m_process->setNextOpenMode(QIODevice::ReadWrite | QIODevice::Unbuffered | QIODevice::Text);
     m_process->setProgram(programPath, arguments);
+    if (!workingDirectory.isEmpty()) {
+        m_process->setWorkingDirectory(workingDirectory);
+    }
 
     connect(m_process, &QProcess::readyReadStandardOutput, this, [=]() {
         readStdout();
@@ -293,9 +315,9 @@ bool CliInterface::runProcess(const QString& programName, const QStringList& arg
 
     if (m_operationMode == Extract) {
         // Extraction jobs need a dedicated post-processing function.
-        connect(m_process, static_cast<void (KPtyProcess::*)(int, QProcess::ExitStatus)>(&KPtyProcess::finished), this, &CliInterface::extractProcessFinished);
+        connect(m_process, static_cast<void (KProcess::*)(int, QProcess::ExitStatus)>(&KProcess::finished), this, &CliInterface::extractProcessFinished);
     } else {
-        connect(m_process, static_cast<void (KPtyProcess::*)(int, QProcess::ExitStatus)>(&KPtyProcess::finished), this, &CliInterface::processFinished);
+        connect(m_process, static_cast<void (KProcess::*)(int, QProcess::ExitStatus)>(&KProcess::finished), this, &CliInterface::processFinished);
     }
 
     m_stdOutData.clear();
@@ -305,6 +327,73 @@ bool CliInterface::runProcess(const QString& programName, const QStringList& arg
     return true;
 }
 
+bool CliInterface::needsInteractiveInput() const
+{
+    switch (m_operationMode) {
+    case List:
+    case Test:
+        // Only header-encrypted archives make the program ask for a password.
+        // Listing them is restarted with a pseudo-terminal once the prompt shows up,
+        // while testing them is not supported.
+        return false;
+    case Extract: {
+        // The password is asked before running the program if the archive is known to be encrypted.
+        if (password().isEmpty() && m_extractionOptions.encryptedArchiveHint() &&
+            !m_cliProps->property("passwordPromptPatterns").toStringList().isEmpty()) {
+            return true;
+        }
+
+        // Existing files can only be found in a destination which is not empty.
+        const QDir destination(m_workingDirectory, QString(), QDir::NoSort,
+                               QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden | QDir::System);
+        return !m_cliProps->property("fileExistsPatterns").toStringList().isEmpty() && destination.count() > 0;
+    }
+    default:
+        return true;
+    }
+}
+
+bool CliInterface::hasInteractiveInput() const
+{
+#ifdef Q_OS_WIN
+    return true;
+#else
+    return qobject_cast<KPtyProcess*>(m_process);
+#endif
+}
+
+bool CliInterface::hasProducedOutput() const
+{
+    if (m_operationMode == List) {
+        return m_numberOfEntries > 0;
+    }
+
+    // Extractions without a pseudo-terminal always start in an empty directory,
+    // see needsInteractiveInput().
+    const QDir destination(m_workingDirectory, QString(), QDir::NoSort,
+                           QDir::AllEntries | QDir::NoDotAndDotDot | QDir::Hidden | QDir::System);
+    return destination.count() > 0;
+}
+
+bool CliInterface::restartWithInteractiveInput()
+{
+    Q_ASSERT(!m_process);
+
+    qCDebug(ARK) << "Restarting the process with a pseudo-terminal";
+
+    m_restartWithInteractiveInput = false;
+    if (m_operationMode == List) {
+        resetParsing();
+        m_numberOfEntries = 0;
+    }
+
+    m_forceInteractiveInput = true;
+    const bool ret = runProcess(m_programName, m_programArguments, m_workingDirectory);
+    m_forceInteractiveInput = false;
+
+    return ret;
+}
+
 void CliInterface::processFinished(int exitCode, QProcess::ExitStatus exitStatus)
 {
     m_exitCode = exitCode;
@@ -324,6 +413,16 @@ void CliInterface::processFinished(int exitCode, QProcess::ExitStatus exitStatus
         return;
     }
 
+    if (m_restartWithInteractiveInput) {
+        // Don't start the new process from within the finished() handler of the old one.
+        QTimer::singleShot(0, this, [this]() {
+            if (m_restartWithInteractiveInput) {
+                restartWithInteractiveInput();
+            }
+        });
+        return;
+    }
+
     if (m_operationMode == Delete || m_operationMode == Move) {
         QStringList removedFullPaths = entryFullPaths(m_removedFiles);
         foreach (const QString &fullPath, removedFullPaths) {
@@ -373,6 +472,16 @@ void CliInterface::extractProcessFinished(int exitCode, QProcess::ExitStatus exi
         return;
     }
 
+    if (m_restartWithInteractiveInput) {
+        // Don't start the new process from within the finished() handler of the old one.
+        QTimer::singleShot(0, this, [this]() {
+            if (m_restartWithInteractiveInput) {
+                restartWithInteractiveInput();
+            }
+        });
+        return;
+    }
+
     if (m_extractionOptions.alwaysUseTempDir()) {
         // unar exits with code 1 if extraction fails.
         // This happens at least with wrong passwords or not enough space in the destination folder.
@@ -391,7 +500,7 @@ void CliInterface::extractProcessFinished(int exitCode, QProcess::ExitStatus exi
         }
 
         if (!m_extractionOptions.isDragAndDropEnabled()) {
-            if (!moveToDestination(QDir::current(), QDir(m_extractDestDir), m_extractionOptions.preservePaths())) {
+            if (!moveToDestination(QDir(m_extractTempDir->path()), QDir(m_extractDestDir), m_extractionOptions.preservePaths())) {
                 emit error(i18ncp("@info",
                                   "Could not move the extracted file to the destination directory.",
                                   "Could not move the extracted files to the destination directory.",
@@ -459,7 +568,7 @@ bool CliInterface::moveDroppedFilesToDest(const QVector<Archive::Entry*> &files,
     foreach (const Archive::Entry *file, files) {
 
         QFileInfo relEntry(file->fullPath().remove(file->rootNode));
-        QFileInfo absSourceEntry(QDir::current().absolutePath() + QLatin1Char('/') + file->fullPath());
+        QFileInfo absSourceEntry(m_workingDirectory + QLatin1Char('/') + file->fullPath());
         QFileInfo absDestEntry(finalDestDir.path() + QLatin1Char('/') + relEntry.filePath());
 
         if (absSourceEntry.isDir()) {
@@ -534,10 +643,6 @@ bool CliInterface::isEmptyDir(const QDir &dir)
 
 void CliInterface::cleanUpExtracting()
 {
-    if (!m_oldWorkingDir.isEmpty()) {
-        QDir::setCurrent(m_oldWorkingDir);
-    }
-
     m_extractTempDir.reset();
 }
 
@@ -723,7 +828,6 @@ void CliInterface::cleanUp()
 {
     qDeleteAll(m_tempAddedFiles);
     m_tempAddedFiles.clear();
-    QDir::setCurrent(m_oldWorkingDir);
     m_tempWorkingDir.reset();
     m_tempAddDir.reset();
 }
@@ -748,10 +852,14 @@ void CliInterface::readStdout(bool handleAll)
         return;
     }
 
-    QByteArray dd = m_process->readAllStandardOutput();
-    m_stdOutData += dd;
+    m_stdOutData += m_process->readAllStandardOutput();
 
-    QList<QByteArray> lines = m_stdOutData.split('\n');
+    // Lines are sliced directly out of the buffer instead of splitting it
+    // into a list of byte arrays: only the QString passed to handleLine()
+    // is allocated for each line.
+    const QByteArray data = m_stdOutData;
+    const int lastNewLine = data.lastIndexOf('\n');
+    const QLatin1String lastLine(data.constData() + lastNewLine + 1, data.size() - lastNewLine - 1);
 
     //The reason for this check is that archivers often do not end
     //queries (such as file exists, wrong password) on a new line, but
@@ -760,16 +868,14 @@ void CliInterface::readStdout(bool handleAll)
     // TODO: QLatin1String() might not be the best choice here.
     //       The call to handleLine() at the end of the method uses
     //       QString::fromLocal8Bit(), for example.
-    // TODO: The same check methods are called in handleLine(), this
-    //       is suboptimal.
 
-    bool wrongPasswordMessage = m_cliProps->isWrongPasswordMsg(QLatin1String(lines.last()));
+    const CliProperties::MessageTypes lastLineTypes = m_cliProps->classifyLine(lastLine);
+    const bool wrongPasswordMessage = lastLineTypes.testFlag(CliProperties::WrongPassword);
 
-    bool foundErrorMessage =
-        (wrongPasswordMessage ||
-         m_cliProps->isDiskFullMsg(QLatin1String(lines.last())) ||
-         m_cliProps->isfileExistsMsg(QLatin1String(lines.last()))) ||
-         m_cliProps->isPasswordPrompt(QLatin1String(lines.last()));
+    const bool foundErrorMessage = lastLineTypes & (CliProperties::WrongPassword |
+                                                    CliProperties::DiskFull |
+                                                    CliProperties::FileExists |
+                                                    CliProperties::PasswordPrompt);
 
     if (foundErrorMessage) {
         handleAll = true;
@@ -784,32 +890,44 @@ void CliInterface::readStdout(bool handleAll)
     //handle in the output. The exception is that it is supposed to handle
     //all the data, OR if there's been an error message found in the
     //partial data.
-    if (lines.size() == 1 && !handleAll) {
+    if (lastNewLine == -1 && !handleAll) {
         return;
     }
 
+    // Update the buffer before handling the lines: handleLine() may run
+    // a query, and new output can be read from its event loop.
     if (handleAll) {
         m_stdOutData.clear();
     } else {
         //because the last line might be incomplete we leave it for now
         //note, this last line may be an empty string if the stdoutdata ends
         //with a newline
-        m_stdOutData = lines.takeLast();
+        m_stdOutData = data.mid(lastNewLine + 1);
     }
 
-    foreach(const QByteArray& line, lines) {
-        if (!line.isEmpty() || (m_listEmptyLines && m_operationMode == List)) {
-            if (!handleLine(QString::fromLocal8Bit(line))) {
+    // The last line is only handled if all the data has to be handled.
+    const int end = handleAll ? data.size() : lastNewLine;
+    int lineStart = 0;
+    while (lineStart <= end) {
+        int lineEnd = data.indexOf('\n', lineStart);
+        if (lineEnd == -1 || lineEnd > end) {
+            lineEnd = end;
+        }
+
+        const int lineLength = lineEnd - lineStart;
+        if (lineLength > 0 || (m_listEmptyLines && m_operationMode == List)) {
+            if (!handleLine(QString::fromLocal8Bit(data.constData() + lineStart, lineLength))) {
                 killProcess();
                 return;
             }
         }
+
+        lineStart = lineEnd + 1;
     }
 }
 
 bool CliInterface::setAddedFiles()
 {
-    QDir::setCurrent(m_tempAddDir->path());
     foreach (const Archive::Entry *file, m_passedFiles) {
         const QString oldPath = m_tempWorkingDir->path() + QLatin1Char('/') + file->fullPath(NoTrailingSlash);
         const QString newPath = m_tempAddDir->path() + QLatin1Char('/') + file->name();
@@ -835,9 +953,29 @@ bool CliInterface::handleLine(const QString& line)
         }
     }
 
+    // Match the line against all the plugin's patterns only once.
+    const CliProperties::MessageTypes types = m_cliProps->classifyLine(line);
+
+    // A prompt can't be answered through pipes: kill the process. It is restarted
+    // with a pseudo-terminal only if it didn't do anything yet, since running it
+    // again would repeat its work and find the files it already extracted.
+    if ((m_operationMode == List || m_operationMode == Extract) && !hasInteractiveInput() &&
+        (types & (CliProperties::PasswordPrompt | CliProperties::FileExists))) {
+        qCDebug(ARK) << "Found a prompt, but the process has no pseudo-terminal";
+        if (hasProducedOutput()) {
+            qCWarning(ARK) << "The process already produced output, not restarting it";
+            emit error(m_operationMode == List
+                       ? i18nc("@info", "The archive could not be listed because the program asked for input after listing some of its entries.")
+                       : i18nc("@info", "The archive could not be extracted because the program asked for input after extracting some of its files."));
+            return false;
+        }
+        m_restartWithInteractiveInput = true;
+        return false;
+    }
+
     if (m_operationMode == Extract) {
 
-        if (m_cliProps->isPasswordPrompt(line)) {
+        if (types.testFlag(CliProperties::PasswordPrompt)) {
             qCDebug(ARK) << "Found a password prompt";
 
             Kerfuffle::PasswordNeededQuery query(filename());
@@ -856,20 +994,20 @@ bool CliInterface::handleLine(const QString& line)
             return true;
         }
 
-        if (m_cliProps->isDiskFullMsg(line)) {
+        if (types.testFlag(CliProperties::DiskFull)) {
             qCWarning(ARK) << "Found disk full message:" << line;
             emit error(i18nc("@info", "Extraction failed because the disk is full."));
             return false;
         }
 
-        if (m_cliProps->isWrongPasswordMsg(line)) {
+        if (types.testFlag(CliProperties::WrongPassword)) {
             qCWarning(ARK) << "Wrong password!";
             setPassword(QString());
             emit error(i18nc("@info", "Extraction failed: Incorrect password"));
             return false;
         }
 
-        if (handleFileExistsMessage(line)) {
+        if (handleFileExistsMessage(line, types)) {
             return true;
         }
 
@@ -877,7 +1015,7 @@ bool CliInterface::handleLine(const QString& line)
     }
 
     if (m_operationMode == List) {
-        if (m_cliProps->isPasswordPrompt(line)) {
+        if (types.testFlag(CliProperties::PasswordPrompt)) {
             qCDebug(ARK) << "Found a password prompt";
 
             Kerfuffle::PasswordNeededQuery query(filename());
@@ -896,21 +1034,21 @@ bool CliInterface::handleLine(const QString& line)
             return true;
         }
 
-        if (m_cliProps->isWrongPasswordMsg(line)) {
+        if (types.testFlag(CliProperties::WrongPassword)) {
             qCWarning(ARK) << "Wrong password!";
             setPassword(QString());
             emit error(i18n("Incorrect password."));
             return false;
         }
 
-        if (m_cliProps->isCorruptArchiveMsg(line)) {
+        if (types.testFlag(CliProperties::CorruptArchive)) {
             qCWarning(ARK) << "Archive corrupt";
             setCorrupt(true);
             // Special case: corrupt is not a "fatal" error so we return true here.
             return true;
         }
 
-        if (handleFileExistsMessage(line)) {
+        if (handleFileExistsMessage(line, types)) {
             return true;
         }
 
@@ -923,14 +1061,14 @@ bool CliInterface::handleLine(const QString& line)
 
     if (m_operationMode == Test) {
 
-        if (m_cliProps->isPasswordPrompt(line)) {
+        if (types.testFlag(CliProperties::PasswordPrompt)) {
             qCDebug(ARK) << "Found a password prompt";
 
             emit error(i18n("Ark does not currently support testing this archive."));
             return false;
         }
 
-        if (m_cliProps->isTestPassedMsg(line)) {
+        if (types.testFlag(CliProperties::TestPassed)) {
             qCDebug(ARK) << "Test successful";
             emit testSuccess();
             return true;
@@ -946,24 +1084,18 @@ bool CliInterface::readDeleteLine(const QString &line)
     return true;
 }
 
-bool CliInterface::handleFileExistsMessage(const QString& line)
+bool CliInterface::handleFileExistsMessage(const QString& line, CliProperties::MessageTypes types)
 {
     // Check for a filename and store it.
-    foreach (const QString &pattern, m_cliProps->property("fileExistsFileName").toStringList()) {
-        const QRegularExpression rxFileNamePattern(pattern);
-        const QRegularExpressionMatch rxMatch = rxFileNamePattern.match(line);
-
-        if (rxMatch.hasMatch()) {
-            m_storedFileName = rxMatch.captured(1);
-            qCWarning(ARK) << "Detected existing file:" << m_storedFileName;
-        }
+    if (types.testFlag(CliProperties::FileExistsFileName) && m_cliProps->matchFileExistsFileName(line, &m_storedFileName)) {
+        qCWarning(ARK) << "Detected existing file:" << m_storedFileName;
     }
 
-    if (!m_cliProps->isfileExistsMsg(line)) {
+    if (!types.testFlag(CliProperties::FileExists)) {
         return false;
     }
 
-    Kerfuffle::OverwriteQuery query(QDir::current().path() + QLatin1Char( '/' ) + m_storedFileName);
+    Kerfuffle::OverwriteQuery query(m_workingDirectory + QLatin1Char( '/' ) + m_storedFileName);
     query.setNoRenameMode(true);
     query.execute();
 
@@ -1001,6 +1133,12 @@ bool CliInterface::doKill()
         return true;
     }
 
+    if (m_restartWithInteractiveInput) {
+        // The process was killed to be restarted with a pseudo-terminal, but it didn't start yet.
+        m_restartWithInteractiveInput = false;
+        return true;
+    }
+
     return false;
 }
 
@@ -1039,11 +1177,15 @@ void CliInterface::writeToProcess(const QByteArray& data)
 
     qCDebug(ARK) << "Writing" << data << "to the process";
 
-#ifdef Q_OS_WIN
-    m_process->write(data);
-#else
-    m_process->pty()->write(data);
+#ifndef Q_OS_WIN
+    KPtyProcess *ptyProcess = qobject_cast<KPtyProcess*>(m_process);
+    if (ptyProcess) {
+        ptyProcess->pty()->write(data);
+        return;
+    }
 #endif
+
+    m_process->write(data);
 }
 
 bool CliInterface::addComment(const QString &comment)
@@ -103,6 +103,19 @@ public:
 
     CliProperties *cliProperties() const;
 
+    /**
+     * Whether the process run for the current operation is expected to ask for
+     * input, for example a password or an overwrite confirmation.
+     *
+     * Such processes get a pseudo-terminal as standard input. All the others are
+     * run through plain pipes, which are faster to read large outputs from.
+     * If a listing or an extraction run through pipes prompts for input anyway,
+     * it is restarted with a pseudo-terminal, unless it already listed entries or
+     * extracted files, in which case it fails.
+     * Plugins whose programs need a terminal in other cases can reimplement this.
+     */
+    virtual bool needsInteractiveInput() const;
+
 protected:
 
     bool setAddedFiles();
@@ -119,11 +132,13 @@ protected:
      *
      * @param programName The program that will be run (not the whole path).
      * @param arguments A list of arguments that will be passed to the program.
+     * @param workingDirectory The directory the program runs in. If empty, the
+     *        current directory of the application is used.
      *
      * @return @c true if the program was found and the process was started correctly,
      *         @c false otherwise (in which case finished(false) is emitted).
      */
-    bool runProcess(const QString& programName, const QStringList& arguments);
+    bool runProcess(const QString& programName, const QStringList& arguments, const QString &workingDirectory = QString());
 
     /**
      * Kill the running process. The finished signal is emitted according to @p emitFinished.
@@ -139,7 +154,6 @@ protected:
     void cleanUp();
 
     CliProperties *m_cliProps = nullptr;
-    QString m_oldWorkingDir;
     QScopedPointer<QTemporaryDir> m_tempWorkingDir;
     QScopedPointer<QTemporaryDir> m_tempAddDir;
     OperationMode m_subOperation = List;
@@ -148,11 +162,7 @@ protected:
     Archive::Entry *m_passedDestination = nullptr;
     CompressionOptions m_passedOptions;
 
-#ifdef Q_OS_WIN
     KProcess *m_process = nullptr;
-#else
-    KPtyProcess *m_process = nullptr;
-#endif
 
     bool m_abortingOperation = false;
 
@@ -161,7 +171,7 @@ protected slots:
 
 private:
 
-    bool handleFileExistsMessage(const QString& filename);
+    bool handleFileExistsMessage(const QString& line, CliProperties::MessageTypes types);
 
     /**
      * Returns a list of path pairs which will be supplied to rn command.
@@ -175,10 +185,28 @@ private:
 
     /**
      * Wrapper around KProcess::write() or KPtyDevice::write(), depending on
-     * the platform.
+     * the platform and on whether the process has a pseudo-terminal.
      */
     void writeToProcess(const QByteArray& data);
 
+    /**
+     * @return Whether input can be written to the running process.
+     */
+    bool hasInteractiveInput() const;
+
+    /**
+     * @return Whether the current listing or extraction already emitted entries
+     * or wrote files to the working directory.
+     */
+    bool hasProducedOutput() const;
+
+    /**
+     * Runs the last process again, with a pseudo-terminal as standard input.
+     * This is only done from the event loop, after the previous process has finished,
+     * and only if that process hadn't produced any output yet.
+     */
+    bool restartWithInteractiveInput();
+
     bool moveDroppedFilesToDest(const QVector<Archive::Entry*> &files, const QString &finalDest);
 
     /**
@@ -201,8 +229,6 @@ private:
     void finishCopying(bool result);
 
     QByteArray m_stdOutData;
-    QRegularExpression m_passwordPromptPattern;
-    QHash<int, QList<QRegularExpression> > m_patternCache;
 
     QVector<Archive::Entry*> m_removedFiles;
     QVector<Archive::Entry*> m_newMovedFiles;
@@ -218,6 +244,12 @@ private:
     qulonglong m_archiveSizeOnDisk = 0;
     qulonglong m_listedSize = 0;
 
+    QString m_programName;
+    QStringList m_programArguments;
+    QString m_workingDirectory;
+    bool m_forceInteractiveInput = false;
+    bool m_restartWithInteractiveInput = false;
+
 protected slots:
     virtual void processFinished(int exitCode, QProcess::ExitStatus exitStatus);
 
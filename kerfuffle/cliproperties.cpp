@@ -288,74 +288,161 @@ QString CliProperties::substituteMultiVolumeSwitch(ulong volumeSize) const
     return multiVolumeSwitch;
 }
 
-bool CliProperties::isPasswordPrompt(const QString &line)
+CliProperties::MessageTypes CliProperties::classifyLine(const QString &line) const
 {
-    foreach(const QString &rx, m_passwordPromptPatterns) {
-        if (QRegularExpression(rx).match(line).hasMatch()) {
-            return true;
+    MessageTypes types = NoMessage;
+    if (m_messageGroups.isEmpty()) {
+        return types;
+    }
+
+    const QRegularExpressionMatch match = m_messageMatcher.match(line);
+    for (const auto &group : m_messageGroups) {
+        if (match.capturedStart(group.second) != -1) {
+            types |= group.first;
         }
     }
-    return false;
+    return types;
 }
 
-bool CliProperties::isWrongPasswordMsg(const QString &line)
+bool CliProperties::matchFileExistsFileName(const QString &line, QString *fileName) const
 {
-    foreach(const QString &rx, m_wrongPasswordPatterns) {
-        if (QRegularExpression(rx).match(line).hasMatch()) {
-            return true;
+    bool matched = false;
+    foreach (const QRegularExpression &rx, m_fileExistsFileNameRegexes) {
+        const QRegularExpressionMatch match = rx.match(line);
+        if (match.hasMatch()) {
+            *fileName = match.captured(1);
+            matched = true;
         }
     }
-    return false;
+    return matched;
 }
 
-bool CliProperties::isTestPassedMsg(const QString &line)
+bool CliProperties::isPasswordPrompt(const QString &line) const
 {
-    foreach(const QString &rx, m_testPassedPatterns) {
-        if (QRegularExpression(rx).match(line).hasMatch()) {
-            return true;
-        }
-    }
-    return false;
+    return classifyLine(line).testFlag(PasswordPrompt);
 }
 
-bool CliProperties::isfileExistsMsg(const QString &line)
+bool CliProperties::isWrongPasswordMsg(const QString &line) const
 {
-    foreach(const QString &rx, m_fileExistsPatterns) {
-        if (QRegularExpression(rx).match(line).hasMatch()) {
-            return true;
-        }
-    }
-    return false;
+    return classifyLine(line).testFlag(WrongPassword);
 }
 
-bool CliProperties::isFileExistsFileName(const QString &line)
+bool CliProperties::isTestPassedMsg(const QString &line) const
 {
-    foreach(const QString &rx, m_fileExistsFileName) {
-        if (QRegularExpression(rx).match(line).hasMatch()) {
-            return true;
-        }
-    }
-    return false;
+    return classifyLine(line).testFlag(TestPassed);
 }
 
-bool CliProperties::isCorruptArchiveMsg(const QString &line)
+bool CliProperties::isfileExistsMsg(const QString &line) const
 {
-    foreach(const QString &rx, m_corruptArchivePatterns) {
-        if (QRegularExpression(rx).match(line).hasMatch()) {
-            return true;
-        }
+    return classifyLine(line).testFlag(FileExists);
+}
+
+bool CliProperties::isFileExistsFileName(const QString &line) const
+{
+    return classifyLine(line).testFlag(FileExistsFileName);
+}
+
+bool CliProperties::isCorruptArchiveMsg(const QString &line) const
+{
+    return classifyLine(line).testFlag(CorruptArchive);
+}
+
+bool CliProperties::isDiskFullMsg(const QString &line) const
+{
+    return classifyLine(line).testFlag(DiskFull);
+}
+
+void CliProperties::setPasswordPromptPatterns(const QStringList &patterns)
+{
+    m_passwordPromptPatterns = patterns;
+    updateMessageMatcher();
+}
+
+void CliProperties::setWrongPasswordPatterns(const QStringList &patterns)
+{
+    m_wrongPasswordPatterns = patterns;
+    updateMessageMatcher();
+}
+
+void CliProperties::setTestPassedPatterns(const QStringList &patterns)
+{
+    m_testPassedPatterns = patterns;
+    updateMessageMatcher();
+}
+
+void CliProperties::setFileExistsPatterns(const QStringList &patterns)
+{
+    m_fileExistsPatterns = patterns;
+    updateMessageMatcher();
+}
+
+void CliProperties::setFileExistsFileName(const QStringList &patterns)
+{
+    m_fileExistsFileName = patterns;
+
+    m_fileExistsFileNameRegexes.clear();
+    foreach (const QString &pattern, patterns) {
+        QRegularExpression rx(pattern);
+        rx.optimize();
+        m_fileExistsFileNameRegexes << rx;
     }
-    return false;
+
+    updateMessageMatcher();
+}
+
+void CliProperties::setCorruptArchivePatterns(const QStringList &patterns)
+{
+    m_corruptArchivePatterns = patterns;
+    updateMessageMatcher();
 }
 
-bool CliProperties::isDiskFullMsg(const QString &line)
+void CliProperties::setDiskFullPatterns(const QStringList &patterns)
 {
-    foreach(const QString &rx, m_diskFullPatterns) {
-        if (QRegularExpression(rx).match(line).hasMatch()) {
-            return true;
+    m_diskFullPatterns = patterns;
+    updateMessageMatcher();
+}
+
+void CliProperties::updateMessageMatcher()
+{
+    const QVector<QPair<MessageType, QStringList> > categories = {
+        { PasswordPrompt, m_passwordPromptPatterns },
+        { WrongPassword, m_wrongPasswordPatterns },
+        { TestPassed, m_testPassedPatterns },
+        { FileExists, m_fileExistsPatterns },
+        { FileExistsFileName, m_fileExistsFileName },
+        { CorruptArchive, m_corruptArchivePatterns },
+        { DiskFull, m_diskFullPatterns }
+    };
+
+    // Every kind of message gets an optional lookahead anchored at the start
+    // of the line, followed by an empty named group. Since lookaheads don't
+    // consume anything, all of them are tried and the set named groups
+    // tell which kinds of message matched, with a single call to match().
+    QString matcher = QStringLiteral("^");
+    m_messageGroups.clear();
+
+    for (const auto &category : categories) {
+        QStringList validPatterns;
+        foreach (const QString &pattern, category.second) {
+            if (QRegularExpression(pattern).isValid()) {
+                validPatterns << pattern;
+            } else {
+                qCWarning(ARK) << "Ignoring invalid pattern:" << pattern;
+            }
+        }
+        if (validPatterns.isEmpty()) {
+            continue;
         }
+
+        const QString groupName = QStringLiteral("type%1").arg(static_cast<int>(category.first));
+        matcher += QLatin1String("(?:(?=[\\s\\S]*?(?:(?:")
+                   + validPatterns.join(QStringLiteral(")|(?:"))
+                   + QLatin1String(")))(?<") + groupName + QLatin1String(">))?");
+        m_messageGroups << qMakePair(category.first, groupName);
     }
-    return false;
+
+    m_messageMatcher.setPattern(matcher);
+    m_messageMatcher.optimize();
 }
 
 }
@@ -62,13 +62,15 @@ class KERFUFFLE_EXPORT CliProperties: public QObject
     Q_PROPERTY(QHash<QString,QVariant> encryptionMethodSwitch MEMBER m_encryptionMethodSwitch)
     Q_PROPERTY(QString multiVolumeSwitch MEMBER m_multiVolumeSwitch)
 
-    Q_PROPERTY(QStringList passwordPromptPatterns MEMBER m_passwordPromptPatterns)
-    Q_PROPERTY(QStringList wrongPasswordPatterns MEMBER m_wrongPasswordPatterns)
-    Q_PROPERTY(QStringList testPassedPatterns MEMBER m_testPassedPatterns)
-    Q_PROPERTY(QStringList fileExistsPatterns MEMBER m_fileExistsPatterns)
-    Q_PROPERTY(QStringList fileExistsFileName MEMBER m_fileExistsFileName)
-    Q_PROPERTY(QStringList corruptArchivePatterns MEMBER m_corruptArchivePatterns)
-    Q_PROPERTY(QStringList diskFullPatterns MEMBER m_diskFullPatterns)
+    // The patterns are compiled once when set, see classifyLine().
+    // They must not use numbered back-references.
+    Q_PROPERTY(QStringList passwordPromptPatterns MEMBER m_passwordPromptPatterns WRITE setPasswordPromptPatterns)
+    Q_PROPERTY(QStringList wrongPasswordPatterns MEMBER m_wrongPasswordPatterns WRITE setWrongPasswordPatterns)
+    Q_PROPERTY(QStringList testPassedPatterns MEMBER m_testPassedPatterns WRITE setTestPassedPatterns)
+    Q_PROPERTY(QStringList fileExistsPatterns MEMBER m_fileExistsPatterns WRITE setFileExistsPatterns)
+    Q_PROPERTY(QStringList fileExistsFileName MEMBER m_fileExistsFileName WRITE setFileExistsFileName)
+    Q_PROPERTY(QStringList corruptArchivePatterns MEMBER m_corruptArchivePatterns WRITE setCorruptArchivePatterns)
+    Q_PROPERTY(QStringList diskFullPatterns MEMBER m_diskFullPatterns WRITE setDiskFullPatterns)
 
     Q_PROPERTY(QStringList fileExistsInput MEMBER m_fileExistsInput)
     Q_PROPERTY(QStringList multiVolumeSuffix MEMBER m_multiVolumeSuffix)
@@ -76,6 +78,21 @@ class KERFUFFLE_EXPORT CliProperties: public QObject
     Q_PROPERTY(bool captureProgress MEMBER m_captureProgress)
 
 public:
+    /**
+     * The kinds of messages recognized by the patterns set by the plugin.
+     */
+    enum MessageType {
+        NoMessage = 0x0,
+        PasswordPrompt = 0x1,
+        WrongPassword = 0x2,
+        TestPassed = 0x4,
+        FileExists = 0x8,
+        FileExistsFileName = 0x10,
+        CorruptArchive = 0x20,
+        DiskFull = 0x40
+    };
+    Q_DECLARE_FLAGS(MessageTypes, MessageType)
+
     explicit CliProperties(QObject *parent, const KPluginMetaData &metaData, const QMimeType &archiveType);
 
     QStringList addArgs(const QString &archive,
@@ -93,15 +110,43 @@ public:
     QStringList moveArgs(const QString &archive, const QVector<Archive::Entry *> &entries, Archive::Entry *destination, const QString &password);
     QStringList testArgs(const QString &archive, const QString &password);
 
-    bool isPasswordPrompt(const QString &line);
-    bool isWrongPasswordMsg(const QString &line);
-    bool isTestPassedMsg(const QString &line);
-    bool isfileExistsMsg(const QString &line);
-    bool isFileExistsFileName(const QString &line);
-    bool isCorruptArchiveMsg(const QString &line);
-    bool isDiskFullMsg(const QString &line);
+    /**
+     * @return The kinds of message that @p line matches, checked with a
+     * single match of an expression combining all the plugin's patterns.
+     */
+    MessageTypes classifyLine(const QString &line) const;
+
+    /**
+     * Stores in @p fileName the file name captured by the last fileExistsFileName
+     * pattern matching @p line. Only worth calling for lines classified as
+     * FileExistsFileName, since this needs a match for every pattern.
+     *
+     * @return Whether any of the patterns matched.
+     */
+    bool matchFileExistsFileName(const QString &line, QString *fileName) const;
+
+    bool isPasswordPrompt(const QString &line) const;
+    bool isWrongPasswordMsg(const QString &line) const;
+    bool isTestPassedMsg(const QString &line) const;
+    bool isfileExistsMsg(const QString &line) const;
+    bool isFileExistsFileName(const QString &line) const;
+    bool isCorruptArchiveMsg(const QString &line) const;
+    bool isDiskFullMsg(const QString &line) const;
 
 private:
+    void setPasswordPromptPatterns(const QStringList &patterns);
+    void setWrongPasswordPatterns(const QStringList &patterns);
+    void setTestPassedPatterns(const QStringList &patterns);
+    void setFileExistsPatterns(const QStringList &patterns);
+    void setFileExistsFileName(const QStringList &patterns);
+    void setCorruptArchivePatterns(const QStringList &patterns);
+    void setDiskFullPatterns(const QStringList &patterns);
+
+    /**
+     * Rebuilds the expression used by classifyLine() from the current patterns.
+     */
+    void updateMessageMatcher();
+
     QStringList substituteCommentSwitch(const QString &commentfile) const;
     QStringList substitutePasswordSwitch(const QString &password, bool headerEnc = false) const;
     QString substituteCompressionLevelSwitch(int level) const;
@@ -140,6 +185,10 @@ private:
     QStringList m_corruptArchivePatterns;
     QStringList m_diskFullPatterns;
 
+    QRegularExpression m_messageMatcher;
+    QVector<QPair<MessageType, QString> > m_messageGroups;
+    QVector<QRegularExpression> m_fileExistsFileNameRegexes;
+
     QStringList m_fileExistsInput;
     QStringList m_multiVolumeSuffix;
 
@@ -148,6 +197,9 @@ private:
     QMimeType m_mimeType;
     KPluginMetaData m_metaData;
 };
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(CliProperties::MessageTypes)
+
 }
 
 #endif /* CLIPROPERTIES_H */
@@ -35,6 +35,7 @@
 #include <KPluginMetaData>
 
 #include <QMimeDatabase>
+#include <QThread>
 
 namespace Kerfuffle
 {
@@ -59,6 +60,10 @@ CompressionOptionsWidget::CompressionOptionsWidget(QWidget *parent,
         volumeSizeSpinbox->setValue(static_cast<double>(m_opts.volumeSize()) / 1024);
     }
 
+    threadsSpinBox->setMaximum(qMax(1, QThread::idealThreadCount()));
+    // Compressing with several threads is opt-in, since it makes the other applications slower.
+    threadsSpinBox->setValue(m_opts.isNumberOfThreadsSet() ? m_opts.numberOfThreads() : 1);
+
     warningMsgWidget->setWordWrap(true);
 }
 
@@ -72,6 +77,7 @@ CompressionOptions CompressionOptionsWidget::commpressionOptions() const
     if (!compMethodComboBox->currentText().isEmpty()) {
         opts.setCompressionMethod(compMethodComboBox->currentText());
     }
+    opts.setNumberOfThreads(numberOfThreads());
 
     return opts;
 }
@@ -90,6 +96,15 @@ QString CompressionOptionsWidget::compressionMethod() const
     return compMethodComboBox->currentText();
 }
 
+int CompressionOptionsWidget::numberOfThreads() const
+{
+    if (threadsSpinBox->isEnabled()) {
+        return threadsSpinBox->value();
+    } else {
+        return 0;
+    }
+}
+
 ulong CompressionOptionsWidget::volumeSize() const
 {
     if (collapsibleMultiVolume->isEnabled() && multiVolumeCheckbox->isChecked()) {
@@ -206,7 +221,17 @@ void CompressionOptionsWidget::updateWidgets()
             compMethodComboBox->setCurrentText(archiveFormat.defaultCompressionMethod());
         }
     }
-    collapsibleCompression->setEnabled(compLevelSlider->isEnabled() || compMethodComboBox->isEnabled());
+    if (archiveFormat.supportsMultithreading()) {
+        lblThreads->setEnabled(true);
+        threadsSpinBox->setEnabled(true);
+        threadsSpinBox->setToolTip(i18n("Number of processor cores used to compress the archive"));
+    } else {
+        lblThreads->setEnabled(false);
+        threadsSpinBox->setEnabled(false);
+        threadsSpinBox->setToolTip(i18n("It is not possible to compress the %1 format with several threads.",
+                                        m_mimetype.comment()));
+    }
+    collapsibleCompression->setEnabled(compLevelSlider->isEnabled() || compMethodComboBox->isEnabled() || threadsSpinBox->isEnabled());
 
     if (archiveFormat.supportsMultiVolume()) {
         collapsibleMultiVolume->setEnabled(true);
@@ -48,6 +48,7 @@ public:
     QString compressionMethod() const;
     QString encryptionMethod() const;
     ulong volumeSize() const;
+    int numberOfThreads() const;
     QString password() const;
     CompressionOptions commpressionOptions() const;
     bool isEncryptionAvailable() const;
@@ -167,6 +167,11 @@ ulong CreateDialog::volumeSize() const
     return m_ui->optionsWidget->volumeSize();
 }
 
+int CreateDialog::numberOfThreads() const
+{
+    return m_ui->optionsWidget->numberOfThreads();
+}
+
 QString CreateDialog::password() const
 {
     return m_ui->optionsWidget->password();
@@ -62,6 +62,7 @@ public:
     QString compressionMethod() const;
     QString encryptionMethod() const;
     ulong volumeSize() const;
+    int numberOfThreads() const;
 
     /**
      * @return Whether the user can encrypt the new archive.
@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2026 The Ark developers <kde-utils-devel@kde.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES ( INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION ) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * ( INCLUDING NEGLIGENCE OR OTHERWISE ) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "filemanifest.h"
+#include "ark_debug.h"
+
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QPair>
+#include <QRunnable>
+#include <QThreadPool>
+
+#include <cstring>
+
+namespace Kerfuffle
+{
+
+class FileManifest::ScanTask : public QRunnable
+{
+public:
+    explicit ScanTask(const QString &path)
+        : m_path(path)
+    {
+    }
+
+    void run() override
+    {
+        FileManifest::scanDirectory(m_path, m_files, true);
+    }
+
+    const QVector<File> &files() const
+    {
+        return m_files;
+    }
+
+private:
+    const QString m_path;
+    QVector<File> m_files;
+};
+
+FileManifest FileManifest::scan(const QStringList &paths, int threadCount)
+{
+    FileManifest manifest;
+
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(qMax(1, threadCount));
+
+    // Each task scans a subdirectory of an added directory. Its files go
+    // right after the file at the index it is paired with.
+    QVector<QPair<int, ScanTask*> > tasks;
+
+    foreach (const QString &path, paths) {
+        manifest.m_files.append(fileForPath(path, false));
+
+        // Unlike the files under them, the added symlinks to directories are followed.
+        if (!QFileInfo(path).isDir()) {
+            continue;
+        }
+
+        QVector<File> children;
+        scanDirectory(path, children, false);
+        foreach (const File &child, children) {
+            manifest.m_files.append(child);
+            if (child.isDir) {
+                auto task = new ScanTask(child.path);
+                task->setAutoDelete(false);
+                tasks.append(qMakePair(manifest.m_files.size(), task));
+                threadPool.start(task);
+            }
+        }
+    }
+
+    threadPool.waitForDone();
+
+    if (tasks.isEmpty()) {
+        return manifest;
+    }
+
+    int totalCount = manifest.m_files.size();
+    foreach (const auto &task, tasks) {
+        totalCount += task.second->files().size();
+    }
+
+    QVector<File> files;
+    files.reserve(totalCount);
+    int index = 0;
+    foreach (const auto &task, tasks) {
+        while (index < task.first) {
+            files.append(manifest.m_files.at(index++));
+        }
+        files += task.second->files();
+        delete task.second;
+    }
+    while (index < manifest.m_files.size()) {
+        files.append(manifest.m_files.at(index++));
+    }
+
+    manifest.m_files = files;
+    return manifest;
+}
+
+int FileManifest::count() const
+{
+    return m_files.size();
+}
+
+bool FileManifest::isEmpty() const
+{
+    return m_files.isEmpty();
+}
+
+const QVector<FileManifest::File> &FileManifest::files() const
+{
+    return m_files;
+}
+
+FileManifest::File FileManifest::fileForPath(const QString &path, bool appendSlash)
+{
+    File file;
+    file.path = path;
+
+#ifndef Q_OS_WIN
+    if (lstat(QFile::encodeName(path).constData(), &file.status) == 0) {
+        file.isDir = S_ISDIR(file.status.st_mode);
+        file.isSymLink = S_ISLNK(file.status.st_mode);
+    } else {
+        qCWarning(ARK) << "Could not stat" << path;
+        memset(&file.status, 0, sizeof(file.status));
+        file.isDir = false;
+        file.isSymLink = false;
+    }
+#else
+    const QFileInfo info(path);
+    file.isSymLink = info.isSymLink();
+    file.isDir = info.isDir() && !file.isSymLink;
+#endif
+
+    if (appendSlash && file.isDir && !path.endsWith(QLatin1Char('/'))) {
+        file.path.append(QLatin1Char('/'));
+    }
+
+    return file;
+}
+
+void FileManifest::scanDirectory(const QString &path, QVector<File> &files, bool recursive)
+{
+    QDirIterator it(path,
+                    QDir::AllEntries | QDir::Readable |
+                    QDir::Hidden | QDir::NoDotAndDotDot,
+                    recursive ? QDirIterator::Subdirectories : QDirIterator::NoIteratorFlags);
+
+    while (it.hasNext()) {
+        files.append(fileForPath(it.next(), true));
+    }
+}
+
+} // namespace Kerfuffle
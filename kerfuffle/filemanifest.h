@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2026 The Ark developers <kde-utils-devel@kde.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES ( INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION ) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * ( INCLUDING NEGLIGENCE OR OTHERWISE ) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef FILEMANIFEST_H
+#define FILEMANIFEST_H
+
+#include "kerfuffle_export.h"
+
+#include <QString>
+#include <QStringList>
+#include <QThread>
+#include <QVector>
+
+#ifndef Q_OS_WIN
+#include <sys/stat.h>
+#endif
+
+namespace Kerfuffle
+{
+
+/**
+ * The files to add to an archive, scanned from the disk only once.
+ *
+ * The files under the added directories are listed right after their
+ * directory, in the order a recursive QDirIterator would list them. The
+ * subdirectories of the added directories are scanned in parallel.
+ */
+class KERFUFFLE_EXPORT FileManifest
+{
+public:
+    struct File
+    {
+        /**
+         * The path of the file, as given for the added files. The paths
+         * of the directories found under them end with a slash.
+         */
+        QString path;
+        bool isDir;
+        bool isSymLink;
+#ifndef Q_OS_WIN
+        /**
+         * The lstat() result for the file.
+         */
+        struct stat status;
+#endif
+    };
+
+    /**
+     * Scans @p paths and everything under the directories among them.
+     * Symlinks to directories are only followed if they are in @p paths.
+     */
+    static FileManifest scan(const QStringList &paths, int threadCount = QThread::idealThreadCount());
+
+    int count() const;
+    bool isEmpty() const;
+    const QVector<File> &files() const;
+
+private:
+    class ScanTask;
+
+    static File fileForPath(const QString &path, bool appendSlash);
+    static void scanDirectory(const QString &path, QVector<File> &files, bool recursive);
+
+    QVector<File> m_files;
+};
+
+} // namespace Kerfuffle
+
+Q_DECLARE_TYPEINFO(Kerfuffle::FileManifest::File, Q_MOVABLE_TYPE);
+
+#endif // FILEMANIFEST_H
@@ -31,7 +31,6 @@
 #include "ark_debug.h"
 
 #include <QDir>
-#include <QDirIterator>
 #include <QFileInfo>
 #include <QRegularExpression>
 #include <QThread>
@@ -156,6 +155,7 @@ void Job::connectToArchiveInterfaceSignals()
     connect(archiveInterface(), &ReadOnlyArchiveInterface::cancelled, this, &Job::onCancelled);
     connect(archiveInterface(), &ReadOnlyArchiveInterface::error, this, &Job::onError);
     connect(archiveInterface(), &ReadOnlyArchiveInterface::entry, this, &Job::onEntry);
+    connect(archiveInterface(), &ReadOnlyArchiveInterface::entriesBatch, this, &Job::onEntriesBatch);
     connect(archiveInterface(), &ReadOnlyArchiveInterface::progress, this, &Job::onProgress);
     connect(archiveInterface(), &ReadOnlyArchiveInterface::info, this, &Job::onInfo);
     connect(archiveInterface(), &ReadOnlyArchiveInterface::finished, this, &Job::onFinished);
@@ -185,6 +185,15 @@ void Job::onError(const QString & message, const QString & details)
 void Job::onEntry(Archive::Entry *entry)
 {
     emit newEntry(entry);
+    emit newEntries(QVector<Archive::Entry*>{entry});
+}
+
+void Job::onEntriesBatch(const QVector<Archive::Entry*> &entries)
+{
+    foreach (Archive::Entry *entry, entries) {
+        emit newEntry(entry);
+    }
+    emit newEntries(entries);
 }
 
 void Job::onProgress(double value)
@@ -262,6 +271,8 @@ void LoadJob::doWork()
     connectToArchiveInterfaceSignals();
 
     bool ret = archiveInterface()->list();
+    // Deliver the entries left in the queue if the plugin failed before flushing them.
+    archiveInterface()->flushEntries();
 
     if (!archiveInterface()->waitForFinishedSignal()) {
         // onFinished() needs to be called after onNewEntry(), because the former reads members set in the latter.
@@ -363,6 +374,7 @@ void BatchExtractJob::doWork()
 
     // Forward LoadJob's signals.
     connect(m_loadJob, &Kerfuffle::Job::newEntry, this, &BatchExtractJob::newEntry);
+    connect(m_loadJob, &Kerfuffle::Job::newEntries, this, &BatchExtractJob::newEntries);
     connect(m_loadJob, &Kerfuffle::Job::userQuery, this, &BatchExtractJob::userQuery);
     m_loadJob->start();
 }
@@ -631,32 +643,14 @@ void AddJob::doWork()
         QDir::setCurrent(globalWorkDir);
     }
 
-    // Count total number of entries to be added.
-    uint totalCount = 0;
-    QElapsedTimer timer;
-    timer.start();
-    foreach (const Archive::Entry* entry, m_entries) {
-        totalCount++;
-        if (QFileInfo(entry->fullPath()).isDir()) {
-            QDirIterator it(entry->fullPath(), QDir::AllEntries | QDir::Readable | QDir::Hidden | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
-            while (it.hasNext()) {
-                it.next();
-                totalCount++;
-            }
-        }
-    }
-
-    qCDebug(ARK) << "AddJob: going to add" << totalCount << "entries, counted in" << timer.elapsed() << "ms";
-
-    const QString desc = i18np("Compressing a file", "Compressing %1 files", totalCount);
-    emit description(this, desc, qMakePair(i18n("Archive"), archiveInterface()->filename()));
-
     ReadWriteArchiveInterface *m_writeInterface =
         qobject_cast<ReadWriteArchiveInterface*>(archiveInterface());
 
     Q_ASSERT(m_writeInterface);
 
     // The file paths must be relative to GlobalWorkDir.
+    QStringList paths;
+    paths.reserve(m_entries.size());
     foreach (Archive::Entry *entry, m_entries) {
         // #191821: workDir must be used instead of QDir::current()
         //          so that symlinks aren't resolved automatically
@@ -668,10 +662,27 @@ void AddJob::doWork()
         }
 
         entry->setFullPath(relativePath);
+        paths << relativePath;
     }
 
+    // Scan the entries to be added once, for both counting them and writing them.
+    QElapsedTimer timer;
+    timer.start();
+    const FileManifest manifest = FileManifest::scan(paths);
+    const uint totalCount = manifest.count();
+
+    qCDebug(ARK) << "AddJob: going to add" << totalCount << "entries, scanned in" << timer.elapsed() << "ms";
+
+    const QString desc = i18np("Compressing a file", "Compressing %1 files", totalCount);
+    emit description(this, desc, qMakePair(i18n("Archive"), archiveInterface()->filename()));
+
+    m_writeInterface->setFileManifest(manifest);
+
     connectToArchiveInterfaceSignals();
     bool ret = m_writeInterface->addFiles(m_entries, m_destination, m_options, totalCount);
+    // Plugins that did not use the manifest must not get it for a later operation.
+    m_writeInterface->setFileManifest(FileManifest());
+    archiveInterface()->flushEntries();
 
     if (!archiveInterface()->waitForFinishedSignal()) {
         onFinished(ret);
@@ -711,6 +722,7 @@ void MoveJob::doWork()
 
     connectToArchiveInterfaceSignals();
     bool ret = m_writeInterface->moveFiles(m_entries, m_destination, m_options);
+    archiveInterface()->flushEntries();
 
     if (!archiveInterface()->waitForFinishedSignal()) {
         onFinished(ret);
@@ -749,6 +761,7 @@ void CopyJob::doWork()
 
     connectToArchiveInterfaceSignals();
     bool ret = m_writeInterface->copyFiles(m_entries, m_destination, m_options);
+    archiveInterface()->flushEntries();
 
     if (!archiveInterface()->waitForFinishedSignal()) {
         onFinished(ret);
@@ -824,6 +837,7 @@ void TestJob::doWork()
 
     connectToArchiveInterfaceSignals();
     connect(archiveInterface(), &ReadOnlyArchiveInterface::testSuccess, this, &TestJob::onTestSuccess);
+    connect(archiveInterface(), &ReadOnlyArchiveInterface::testFailure, this, &TestJob::onTestFailure);
 
     bool ret = archiveInterface()->testArchive();
 
@@ -837,11 +851,21 @@ void TestJob::onTestSuccess()
     m_testSuccess = true;
 }
 
+void TestJob::onTestFailure(const QString &entry, const QString &reason)
+{
+    m_failedEntries << i18nc("@item:inlistbox An archive entry and why it failed the integrity test", "%1: %2", entry, reason);
+}
+
 bool TestJob::testSucceeded()
 {
     return m_testSuccess;
 }
 
+QStringList TestJob::failedEntries() const
+{
+    return m_failedEntries;
+}
+
 } // namespace Kerfuffle
 
 #include "jobs.moc"
@@ -77,6 +77,7 @@ protected slots:
     virtual void onError(const QString &message, const QString &details);
     virtual void onInfo(const QString &info);
     virtual void onEntry(Archive::Entry *entry);
+    virtual void onEntriesBatch(const QVector<Archive::Entry*> &entries);
     virtual void onProgress(double progress);
     virtual void onEntryRemoved(const QString &path);
     virtual void onFinished(bool result);
@@ -84,7 +85,18 @@ protected slots:
 
 signals:
     void entryRemoved(const QString & entry);
+
+    /**
+     * Emitted for every new entry, whether the plugin delivered it on its own or in a batch.
+     * Consumers handling many entries should connect to newEntries() instead.
+     */
     void newEntry(Archive::Entry*);
+
+    /**
+     * Emitted for every batch of new entries. Entries delivered one by one
+     * by the plugin are emitted as one-element batches.
+     */
+    void newEntries(const QVector<Archive::Entry*> &entries);
     void userQuery(Kerfuffle::Query*);
 
 private:
@@ -161,6 +173,7 @@ public:
 
 signals:
     void newEntry(Archive::Entry *entry);
+    void newEntries(const QVector<Archive::Entry*> &entries);
     void userQuery(Query *query);
 
 public slots:
@@ -418,14 +431,21 @@ public:
     explicit TestJob(ReadOnlyArchiveInterface *interface);
     bool testSucceeded();
 
+    /**
+     * @return The entries reported to have failed the test, each with the reason.
+     */
+    QStringList failedEntries() const;
+
 public slots:
     void doWork() override;
 
 private slots:
     virtual void onTestSuccess();
+    void onTestFailure(const QString &entry, const QString &reason);
 
 private:
     bool m_testSuccess;
+    QStringList m_failedEntries;
 
 };
 
@@ -80,6 +80,11 @@ bool CompressionOptions::isVolumeSizeSet() const
     return volumeSize() > 0;
 }
 
+bool CompressionOptions::isNumberOfThreadsSet() const
+{
+    return numberOfThreads() > 0;
+}
+
 int CompressionOptions::compressionLevel() const
 {
     return m_compressionLevel;
@@ -100,6 +105,16 @@ void CompressionOptions::setVolumeSize(ulong size)
     m_volumeSize = size;
 }
 
+int CompressionOptions::numberOfThreads() const
+{
+    return m_numberOfThreads;
+}
+
+void CompressionOptions::setNumberOfThreads(int threads)
+{
+    m_numberOfThreads = threads;
+}
+
 QString CompressionOptions::compressionMethod() const
 {
     return m_compressionMethod;
@@ -144,6 +159,7 @@ QDebug operator<<(QDebug d, const CompressionOptions &options)
     }
     d.nospace() << ", compression level: " << options.compressionLevel();
     d.nospace() << ", volume size: " << options.volumeSize();
+    d.nospace() << ", threads: " << options.numberOfThreads();
     d.nospace() << ")";
     return d.space();
 }
@@ -65,10 +65,19 @@ public:
      */
     bool isVolumeSizeSet() const;
 
+    /**
+     * @return Whether a number of compression threads has been set in the options.
+     * If false, the plugins compress with a single thread.
+     * @see numberOfThreads()
+     */
+    bool isNumberOfThreadsSet() const;
+
     int compressionLevel() const;
     void setCompressionLevel(int level);
     ulong volumeSize() const;
     void setVolumeSize(ulong size);
+    int numberOfThreads() const;
+    void setNumberOfThreads(int threads);
     QString compressionMethod() const;
     void setCompressionMethod(const QString &method);
     QString encryptionMethod() const;
@@ -79,6 +88,7 @@ public:
 private:
     int m_compressionLevel = -1;
     ulong m_volumeSize = 0;
+    int m_numberOfThreads = 0;
     QString m_compressionMethod;
     QString m_encryptionMethod;
     QString m_globalWorkDir;
@@ -62,6 +62,8 @@ void Query::waitForResponse()
 
 void Query::setResponse(const QVariant &response)
 {
+    // Locked so that the response cannot be set between the check and the wait in waitForResponse().
+    QMutexLocker locker(&m_responseMutex);
     m_data[QStringLiteral( "response" )] = response;
     m_responseCondition.wakeAll();
 }
@@ -58,6 +58,11 @@ public:
 
     QVariant response() const;
 
+    /**
+     * Sets the response and wakes up the thread waiting for it.
+     */
+    void setResponse(const QVariant &response);
+
 protected:
     /**
      * Protected constructor
@@ -65,8 +70,6 @@ protected:
     Query();
     virtual ~Query() {}
 
-    void setResponse(const QVariant &response);
-
     QueryData m_data;
 
 private:
@@ -33,6 +33,7 @@
 #include <QMimeData>
 #include <QMimeDatabase>
 #include <QRegularExpression>
+#include <QSet>
 #include <QUrl>
 
 using namespace Kerfuffle;
@@ -41,6 +42,9 @@ using namespace Kerfuffle;
 static Archive::Entry *s_previousMatch = nullptr;
 Q_GLOBAL_STATIC(QStringList, s_previousPieces)
 
+// The largest number of suffixes whose icon is cached.
+static const int maxCachedSuffixes = 1000;
+
 ArchiveModel::ArchiveModel(const QString &dbusPathName, QObject *parent)
     : QAbstractItemModel(parent)
     , m_dbusPathName(dbusPathName)
@@ -128,8 +132,11 @@ QVariant ArchiveModel::data(const QModelIndex &index, int role) const
         case Qt::DecorationRole:
             if (index.column() == 0) {
                 const Archive::Entry *e = static_cast<Archive::Entry*>(index.internalPointer());
-                QIcon::Mode mode = (filesToMove.contains(e->fullPath())) ? QIcon::Disabled : QIcon::Normal;
-                return m_entryIcons.value(e->fullPath(NoTrailingSlash)).pixmap(IconSize(KIconLoader::Small), IconSize(KIconLoader::Small), mode);
+                const QPixmap pixmap = iconForEntry(e);
+                if (filesToMove.contains(e->fullPath())) {
+                    return QIcon(pixmap).pixmap(pixmap.size(), QIcon::Disabled);
+                }
+                return pixmap;
             }
             return QVariant();
         case Qt::FontRole: {
@@ -435,7 +442,6 @@ void ArchiveModel::slotEntryRemoved(const QString & path)
         Q_UNUSED(index);
 
         beginRemoveRows(indexForEntry(parent), entry->row(), entry->row());
-        m_entryIcons.remove(parent->entries().at(entry->row())->fullPath(NoTrailingSlash));
         parent->removeEntryAt(entry->row());
         endRemoveRows();
     }
@@ -456,11 +462,80 @@ void ArchiveModel::slotListEntry(Archive::Entry *entry)
     newEntry(entry, DoNotNotifyViews);
 }
 
+void ArchiveModel::slotNewEntries(const QVector<Archive::Entry*> &entries)
+{
+    newEntries(entries, NotifyViews);
+}
+
+void ArchiveModel::slotListEntries(const QVector<Archive::Entry*> &entries)
+{
+    newEntries(entries, DoNotNotifyViews);
+}
+
 void ArchiveModel::newEntry(Archive::Entry *receivedEntry, InsertBehaviour behaviour)
+{
+    Archive::Entry *parent = parentForNewEntry(receivedEntry, behaviour);
+    if (parent) {
+        insertEntry(receivedEntry, behaviour);
+    }
+}
+
+void ArchiveModel::newEntries(const QVector<Archive::Entry*> &entries, InsertBehaviour behaviour)
+{
+    // Consecutive files with the same parent are inserted together, so that
+    // views get a single rowsInserted() for them. Directories are inserted
+    // right away, since the following entries may need them as parent.
+    Archive::Entry *pendingParent = nullptr;
+    QVector<Archive::Entry*> pendingEntries;
+    QSet<QString> pendingNames;
+
+    auto insertPendingEntries = [&]() {
+        if (!pendingEntries.isEmpty()) {
+            insertEntries(pendingParent, pendingEntries, behaviour);
+        }
+        pendingParent = nullptr;
+        pendingEntries.clear();
+        pendingNames.clear();
+    };
+
+    foreach (Archive::Entry *receivedEntry, entries) {
+        Archive::Entry *parent = parentForNewEntry(receivedEntry, behaviour);
+        if (!parent) {
+            continue;
+        }
+
+        // Pending entries can't be found in the tree yet: if the new entry has
+        // the same name as one of them, insert them first and try again.
+        if (parent == pendingParent && pendingNames.contains(receivedEntry->name())) {
+            insertPendingEntries();
+            parent = parentForNewEntry(receivedEntry, behaviour);
+            if (!parent) {
+                continue;
+            }
+        }
+
+        if (receivedEntry->isDir()) {
+            insertPendingEntries();
+            insertEntry(receivedEntry, behaviour);
+            continue;
+        }
+
+        if (parent != pendingParent) {
+            insertPendingEntries();
+            pendingParent = parent;
+        }
+        pendingEntries << receivedEntry;
+        pendingNames << receivedEntry->name();
+    }
+
+    insertPendingEntries();
+}
+
+Archive::Entry *ArchiveModel::parentForNewEntry(Archive::Entry *receivedEntry, InsertBehaviour behaviour)
 {
     if (receivedEntry->fullPath().isEmpty()) {
         qCDebug(ARK) << "Weird, received empty entry (no filename) - skipping";
-        return;
+        return nullptr;
     }
 
     //if there are no addidional columns registered, then have a look at the
@@ -497,7 +572,7 @@ void ArchiveModel::newEntry(Archive::Entry *receivedEntry, InsertBehaviour behav
     // #355839: Entries called "//" should be ignored
     QString entryFileName = cleanFileName(receivedEntry->fullPath());
     if (entryFileName.isEmpty()) { // The entry contains only "." or "./"
-        return;
+        return nullptr;
     }
     receivedEntry->setProperty("fullPath", entryFileName);
 
@@ -517,22 +592,22 @@ void ArchiveModel::newEntry(Archive::Entry *receivedEntry, InsertBehaviour behav
         // In that case, we need to sum the compressed size for each volume
         qulonglong currentCompressedSize = existing->property("compressedSize").toULongLong();
         existing->setProperty("compressedSize", currentCompressedSize + receivedEntry->property("compressedSize").toULongLong());
-        return;
+        return nullptr;
     }
 
     // Find parent entry, creating missing directory Archive::Entry's in the process.
     Archive::Entry *parent = parentFor(receivedEntry, behaviour);
 
     // Create an Archive::Entry.
-    const QStringList path = entryFileName.split(QLatin1Char('/'), QString::SkipEmptyParts);
-    Archive::Entry *entry = parent->find(path.last());
+    Archive::Entry *entry = parent->find(receivedEntry->name());
     if (entry) {
         entry->copyMetaData(receivedEntry);
         entry->setProperty("fullPath", entryFileName);
-    } else {
-        receivedEntry->setParent(parent);
-        insertEntry(receivedEntry, behaviour);
+        return nullptr;
     }
+
+    receivedEntry->setParent(parent);
+    return parent;
 }
 
 void ArchiveModel::slotLoadingFinished(KJob *job)
@@ -551,25 +626,64 @@ void ArchiveModel::slotLoadingFinished(KJob *job)
 void ArchiveModel::insertEntry(Archive::Entry *entry, InsertBehaviour behaviour)
 {
     Q_ASSERT(entry);
-    Archive::Entry *parent = entry->getParent();
+    insertEntries(entry->getParent(), QVector<Archive::Entry*>{entry}, behaviour);
+}
+
+void ArchiveModel::insertEntries(Archive::Entry *parent, const QVector<Archive::Entry*> &entries, InsertBehaviour behaviour)
+{
     Q_ASSERT(parent);
+    Q_ASSERT(!entries.isEmpty());
+    const int first = parent->entries().count();
     if (behaviour == NotifyViews) {
-        beginInsertRows(indexForEntry(parent), parent->entries().count(), parent->entries().count());
+        beginInsertRows(indexForEntry(parent), first, first + entries.count() - 1);
+    }
+    foreach (Archive::Entry *entry, entries) {
+        Q_ASSERT(entry->getParent() == parent);
+        parent->appendEntry(entry);
     }
-    parent->appendEntry(entry);
     if (behaviour == NotifyViews) {
         endInsertRows();
     }
+}
 
-    // Save an icon for each newly added entry.
+QPixmap ArchiveModel::iconForEntry(const Archive::Entry *entry) const
+{
+    // The entries whose MIME type was matched through the same suffix glob
+    // (e.g. "*.tar.gz") share the icon. The names matched by a literal glob
+    // (e.g. "CMakeLists.txt") or by no suffix have no key and are not cached
+    // by name, so that the cache does not grow with the archive.
     QMimeDatabase db;
-    QIcon icon;
-    entry->isDir()
-    ? icon = QIcon::fromTheme(db.mimeTypeForName(QStringLiteral("inode/directory")).iconName()).pixmap(IconSize(KIconLoader::Small),
-                                                                                                       IconSize(KIconLoader::Small))
-    : icon = QIcon::fromTheme(db.mimeTypeForFile(entry->fullPath()).iconName()).pixmap(IconSize(KIconLoader::Small),
-                                                                                       IconSize(KIconLoader::Small));
-    m_entryIcons.insert(entry->fullPath(NoTrailingSlash), icon);
+    const QString name = entry->name();
+    const QString suffix = entry->isDir() ? QStringLiteral("/") : db.suffixForFileName(name);
+
+    if (!suffix.isEmpty()) {
+        auto it = m_suffixIcons.constFind(suffix);
+        if (it != m_suffixIcons.constEnd()) {
+            return *it;
+        }
+    }
+
+    // Only the file name matters: the entry doesn't exist on disk, and
+    // matching the contents of a local file with the same path would be
+    // both slow and wrong.
+    const QMimeType mimeType = entry->isDir()
+                               ? db.mimeTypeForName(QStringLiteral("inode/directory"))
+                               : db.mimeTypeForFile(name, QMimeDatabase::MatchExtension);
+
+    auto iconIt = m_mimeIcons.constFind(mimeType.name());
+    if (iconIt == m_mimeIcons.constEnd()) {
+        const QPixmap pixmap = QIcon::fromTheme(mimeType.iconName()).pixmap(IconSize(KIconLoader::Small),
+                                                                            IconSize(KIconLoader::Small));
+        iconIt = m_mimeIcons.insert(mimeType.name(), pixmap);
+    }
+    if (!suffix.isEmpty()) {
+        // Archives with many distinct suffixes don't make the cache grow forever.
+        if (m_suffixIcons.size() >= maxCachedSuffixes) {
+            m_suffixIcons.clear();
+        }
+        m_suffixIcons.insert(suffix, *iconIt);
+    }
+    return *iconIt;
 }
 
 Kerfuffle::Archive* ArchiveModel::archive() const
@@ -602,7 +716,7 @@ KJob *ArchiveModel::loadArchive(const QString &path, const QString &mimeType, QO
 
     auto loadJob = Archive::load(path, mimeType, parent);
     connect(loadJob, &KJob::result, this, &ArchiveModel::slotLoadingFinished);
-    connect(loadJob, &Job::newEntry, this, &ArchiveModel::slotListEntry);
+    connect(loadJob, &Job::newEntries, this, &ArchiveModel::slotListEntries);
     connect(loadJob, &Job::userQuery, this, &ArchiveModel::slotUserQuery);
 
     emit loadingStarted();
@@ -656,7 +770,7 @@ AddJob* ArchiveModel::addFiles(QVector<Archive::Entry*> &entries, const Archive:
 
     if (!m_archive->isReadOnly()) {
         AddJob *job = m_archive->addFiles(entries, destination, options);
-        connect(job, &AddJob::newEntry, this, &ArchiveModel::slotNewEntry);
+        connect(job, &AddJob::newEntries, this, &ArchiveModel::slotNewEntries);
         connect(job, &AddJob::userQuery, this, &ArchiveModel::slotUserQuery);
 
 
@@ -673,7 +787,7 @@ Kerfuffle::MoveJob *ArchiveModel::moveFiles(QVector<Archive::Entry*> &entries, A
 
     if (!m_archive->isReadOnly()) {
         MoveJob *job = m_archive->moveFiles(entries, destination, options);
-        connect(job, &MoveJob::newEntry, this, &ArchiveModel::slotNewEntry);
+        connect(job, &MoveJob::newEntries, this, &ArchiveModel::slotNewEntries);
         connect(job, &MoveJob::userQuery, this, &ArchiveModel::slotUserQuery);
         connect(job, &MoveJob::entryRemoved, this, &ArchiveModel::slotEntryRemoved);
         connect(job, &MoveJob::finished, this, &ArchiveModel::slotCleanupEmptyDirs);
@@ -691,7 +805,7 @@ Kerfuffle::CopyJob *ArchiveModel::copyFiles(QVector<Archive::Entry*> &entries, A
 
     if (!m_archive->isReadOnly()) {
         CopyJob *job = m_archive->copyFiles(entries, destination, options);
-        connect(job, &CopyJob::newEntry, this, &ArchiveModel::slotNewEntry);
+        connect(job, &CopyJob::newEntries, this, &ArchiveModel::slotNewEntries);
         connect(job, &CopyJob::userQuery, this, &ArchiveModel::slotUserQuery);
 
 
@@ -804,9 +918,13 @@ QMap<QString, Archive::Entry*> ArchiveModel::entryMap(const QVector<Archive::Ent
     return map;
 }
 
-const QHash<QString, QIcon> ArchiveModel::entryIcons() const
+QHash<QString, QIcon> ArchiveModel::entryIcons(const QList<const Archive::Entry*> &entries) const
 {
-    return m_entryIcons;
+    QHash<QString, QIcon> icons;
+    foreach (const Archive::Entry *entry, entries) {
+        icons.insert(entry->fullPath(NoTrailingSlash), QIcon(iconForEntry(entry)));
+    }
+    return icons;
 }
 
 void ArchiveModel::slotCleanupEmptyDirs()
@@ -839,7 +957,6 @@ void ArchiveModel::slotCleanupEmptyDirs()
         Archive::Entry *rawEntry = static_cast<Archive::Entry*>(node.internalPointer());
         qCDebug(ARK) << "Delete with parent entries " << rawEntry->getParent()->entries() << " and row " << rawEntry->row();
         beginRemoveRows(parent(node), rawEntry->row(), rawEntry->row());
-        m_entryIcons.remove(rawEntry->getParent()->entries().at(rawEntry->row())->fullPath(NoTrailingSlash));
         rawEntry->getParent()->removeEntryAt(rawEntry->row());
         endRemoveRows();
     }
@@ -28,6 +28,7 @@
 #include <KMessageWidget>
 
 #include <QAbstractItemModel>
+#include <QPixmap>
 #include <QScopedPointer>
 
 using Kerfuffle::Archive;
@@ -133,7 +134,10 @@ public:
 
     static QMap<QString, Archive::Entry*> entryMap(const QVector<Archive::Entry*> &entries);
 
-    const QHash<QString, QIcon> entryIcons() const;
+    /**
+     * @return The icons of @p entries, indexed by their path without trailing slash.
+     */
+    QHash<QString, QIcon> entryIcons(const QList<const Archive::Entry*> &entries) const;
 
     QMap<QString, Kerfuffle::Archive::Entry*> filesToMove;
     QMap<QString, Kerfuffle::Archive::Entry*> filesToCopy;
@@ -149,6 +153,8 @@ signals:
 private slots:
     void slotNewEntry(Archive::Entry *entry);
     void slotListEntry(Archive::Entry *entry);
+    void slotNewEntries(const QVector<Archive::Entry*> &entries);
+    void slotListEntries(const QVector<Archive::Entry*> &entries);
     void slotLoadingFinished(KJob *job);
     void slotEntryRemoved(const QString & path);
     void slotUserQuery(Kerfuffle::Query *query);
@@ -179,14 +185,37 @@ private:
      */
 
     void insertEntry(Archive::Entry *entry, InsertBehaviour behaviour = NotifyViews);
+
+    /**
+     * Insert @p entries, which must all be children of @p parent, with a single
+     * notification to the views.
+     */
+    void insertEntries(Archive::Entry *parent, const QVector<Archive::Entry*> &entries, InsertBehaviour behaviour);
     void newEntry(Kerfuffle::Archive::Entry *receivedEntry, InsertBehaviour behaviour);
+    void newEntries(const QVector<Archive::Entry*> &entries, InsertBehaviour behaviour);
+
+    /**
+     * Prepares @p receivedEntry to be inserted in the model, creating its missing parent directories.
+     *
+     * @return The parent under which @p receivedEntry has to be inserted, or nullptr if the entry
+     * has been skipped or merged into an already existing entry.
+     */
+    Archive::Entry *parentForNewEntry(Archive::Entry *receivedEntry, InsertBehaviour behaviour);
 
     void traverseAndCountDirNode(Archive::Entry *dir);
 
+    /**
+     * @return The icon for the MIME type of @p entry. MIME types and icons are
+     * only resolved when first needed, and then cached by the suffix the MIME
+     * type was matched on.
+     */
+    QPixmap iconForEntry(const Archive::Entry *entry) const;
+
     QList<int> m_showColumns;
     QScopedPointer<Kerfuffle::Archive> m_archive;
     QScopedPointer<Archive::Entry> m_rootEntry;
-    QHash<QString, QIcon> m_entryIcons;
+    mutable QHash<QString, QPixmap> m_mimeIcons;
+    mutable QHash<QString, QPixmap> m_suffixIcons;
     QMap<int, QByteArray> m_propertiesMap;
 
     QString m_dbusPathName;
@@ -660,6 +660,9 @@ void Part::slotTestingDone(KJob* job)
         KMessageBox::error(widget(), job->errorString());
     } else if (static_cast<TestJob*>(job)->testSucceeded()) {
         KMessageBox::information(widget(), i18n("The archive passed the integrity test."), i18n("Test Results"));
+    } else if (!static_cast<TestJob*>(job)->failedEntries().isEmpty()) {
+        KMessageBox::errorList(widget(), i18n("The archive failed the integrity test. These entries are damaged:"),
+                               static_cast<TestJob*>(job)->failedEntries(), i18n("Test Results"));
     } else {
         KMessageBox::error(widget(), i18n("The archive failed the integrity test."), i18n("Test Results"));
     }
@@ -1309,7 +1312,7 @@ void Part::slotAddFiles(const QStringList& filesToAdd, const Archive::Entry *des
     bool error = m_model->conflictingEntries(conflictingEntries, withChildPaths, true);
 
     if (conflictingEntries.count() > 0) {
-        QPointer<OverwriteDialog> overwriteDialog = new OverwriteDialog(widget(), conflictingEntries, m_model->entryIcons(), error);
+        QPointer<OverwriteDialog> overwriteDialog = new OverwriteDialog(widget(), conflictingEntries, m_model->entryIcons(conflictingEntries), error);
         int ret = overwriteDialog->exec();
         delete overwriteDialog;
         if (ret == QDialog::Rejected) {
@@ -1379,6 +1382,9 @@ void Part::slotAddFiles()
     if (!m_compressionOptions.isVolumeSizeSet() && arguments().metaData().contains(QStringLiteral("volumeSize"))) {
         m_compressionOptions.setVolumeSize(arguments().metaData()[QStringLiteral("volumeSize")].toULong());
     }
+    if (!m_compressionOptions.isNumberOfThreadsSet() && arguments().metaData().contains(QStringLiteral("numberOfThreads"))) {
+        m_compressionOptions.setNumberOfThreads(arguments().metaData()[QStringLiteral("numberOfThreads")].toInt());
+    }
 
     const auto compressionMethods = m_model->archive()->property("compressionMethods").toStringList();
     qCDebug(ARK) << "compmethods:" << compressionMethods;
@@ -1537,7 +1543,7 @@ void Part::slotPasteFiles(QVector<Kerfuffle::Archive::Entry*> &files, Kerfuffle:
     bool error = m_model->conflictingEntries(conflictingEntries, newPaths, false);
 
     if (conflictingEntries.count() != 0) {
-        QPointer<OverwriteDialog> overwriteDialog = new OverwriteDialog(widget(), conflictingEntries, m_model->entryIcons(), error);
+        QPointer<OverwriteDialog> overwriteDialog = new OverwriteDialog(widget(), conflictingEntries, m_model->entryIcons(conflictingEntries), error);
         int ret = overwriteDialog->exec();
         delete overwriteDialog;
         if (ret == QDialog::Rejected) {
@@ -29,7 +29,7 @@
 
 #include <KLocalizedString>
 #include <KPluginFactory>
-#include <KPtyProcess>
+#include <KProcess>
 
 using namespace Kerfuffle;
 
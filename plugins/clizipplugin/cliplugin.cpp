@@ -28,7 +28,6 @@
 #include <KPluginFactory>
 
 #include <QDateTime>
-#include <QDir>
 #include <QRegularExpression>
 #include <QTemporaryDir>
 
@@ -211,10 +210,8 @@ bool CliPlugin::moveFiles(const QVector<Archive::Entry*> &files, Archive::Entry
 {
     qCDebug(ARK) << "Moving" << files.count() << "file(s) to destination:" << destination;
 
-    m_oldWorkingDir = QDir::currentPath();
     m_tempWorkingDir.reset(new QTemporaryDir());
     m_tempAddDir.reset(new QTemporaryDir());
-    QDir::setCurrent(m_tempWorkingDir->path());
     m_passedFiles = files;
     m_passedDestination = destination;
     m_passedOptions = options;
@@ -222,7 +219,7 @@ bool CliPlugin::moveFiles(const QVector<Archive::Entry*> &files, Archive::Entry
     m_subOperation = Extract;
     connect(this, &CliPlugin::finished, this, &CliPlugin::continueMoving);
 
-    return extractFiles(files, QDir::currentPath(), ExtractionOptions());
+    return extractFiles(files, m_tempWorkingDir->path(), ExtractionOptions());
 }
 
 int CliPlugin::moveRequiredSignals() const {
@@ -266,7 +263,6 @@ bool CliPlugin::setMovingAddedFiles()
         return setAddedFiles();
     }
 
-    QDir::setCurrent(m_tempAddDir->path());
     const Archive::Entry *file = m_passedFiles.at(0);
     const QString oldPath = m_tempWorkingDir->path() + QLatin1Char('/') + file->fullPath(NoTrailingSlash);
     const QString newPath = m_tempAddDir->path() + QLatin1Char('/') + m_passedDestination->name();
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2026 The Ark developers <kde-utils-devel@kde.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES ( INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION ) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * ( INCLUDING NEGLIGENCE OR OTHERWISE ) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "entryselection.h"
+
+#include <QStringList>
+
+#include <algorithm>
+
+EntrySelection::EntrySelection(const QVector<Archive::Entry*> &entries)
+    : m_isEmpty(entries.isEmpty())
+{
+    QStringList directories;
+    QStringList paths;
+    paths.reserve(entries.size());
+    m_remainingEntries.reserve(entries.size());
+
+    foreach (const Archive::Entry *entry, entries) {
+        const QString path = entry->fullPath(NoTrailingSlash);
+        m_remainingEntries.insert(path, entry);
+
+        if (entry->isDir() || entry->fullPath().endsWith(QLatin1Char('/'))) {
+            directories << path + QLatin1Char('/');
+            paths << path + QLatin1Char('/');
+        } else {
+            paths << path;
+        }
+    }
+
+    // The paths under a directory come right after it once sorted. A directory
+    // followed by one of its descendants has its contents selected explicitly.
+    paths.sort();
+    foreach (const QString &directory, directories) {
+        const auto next = std::upper_bound(paths.constBegin(), paths.constEnd(), directory);
+        if (next == paths.constEnd() || !next->startsWith(directory)) {
+            const QString path = key(directory);
+            m_directories.insert(path, m_remainingEntries.value(path));
+        }
+    }
+}
+
+bool EntrySelection::isEmpty() const
+{
+    return m_isEmpty;
+}
+
+const Archive::Entry *EntrySelection::match(const QString &path) const
+{
+    const QString entryKey = key(path);
+
+    const Archive::Entry *entry = m_remainingEntries.value(entryKey);
+    if (entry || m_directories.isEmpty()) {
+        return entry;
+    }
+
+    // Look for a selected ancestor directory.
+    int slash = entryKey.lastIndexOf(QLatin1Char('/'));
+    while (slash > 0) {
+        entry = m_directories.value(entryKey.left(slash));
+        if (entry) {
+            return entry;
+        }
+        slash = entryKey.lastIndexOf(QLatin1Char('/'), slash - 1);
+    }
+
+    return nullptr;
+}
+
+void EntrySelection::setExtracted(const Archive::Entry *entry)
+{
+    // Entries under a directory are matched by it, but are not the directory.
+    const QString entryKey = entry->fullPath(NoTrailingSlash);
+    if (!m_directories.contains(entryKey)) {
+        m_remainingEntries.remove(entryKey);
+    }
+}
+
+bool EntrySelection::isComplete() const
+{
+    return !m_isEmpty && m_directories.isEmpty() && m_remainingEntries.isEmpty();
+}
+
+QString EntrySelection::key(const QString &path)
+{
+    return path.endsWith(QLatin1Char('/')) ? path.left(path.size() - 1) : path;
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2026 The Ark developers <kde-utils-devel@kde.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES ( INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION ) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * ( INCLUDING NEGLIGENCE OR OTHERWISE ) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ENTRYSELECTION_H
+#define ENTRYSELECTION_H
+
+#include "archiveentry.h"
+
+#include <QHash>
+#include <QSet>
+
+using Kerfuffle::Archive;
+
+/**
+ * The entries selected for a partial extraction, indexed for matching the
+ * paths read from an archive.
+ *
+ * A path is matched by a selected entry with the same path. A selected
+ * directory which is the only selected entry of its subtree matches all
+ * the paths under it. The cost of a match does not depend on the size of
+ * the selection.
+ */
+class EntrySelection
+{
+public:
+    explicit EntrySelection(const QVector<Archive::Entry*> &entries);
+
+    bool isEmpty() const;
+
+    /**
+     * @return The selected entry matching @p path, or nullptr. Once an entry
+     *         has been marked as extracted, it does not match its path anymore.
+     */
+    const Archive::Entry *match(const QString &path) const;
+
+    /**
+     * Marks @p entry, as returned by match(), as extracted.
+     */
+    void setExtracted(const Archive::Entry *entry);
+
+    /**
+     * @return Whether the archive can't contain other paths matching the selection.
+     */
+    bool isComplete() const;
+
+private:
+    static QString key(const QString &path);
+
+    // The selected entries still to be extracted, by path without trailing slash.
+    QHash<QString, const Archive::Entry*> m_remainingEntries;
+    // The selected directories matching the whole subtree.
+    QHash<QString, const Archive::Entry*> m_directories;
+    bool m_isEmpty;
+};
+
+#endif // ENTRYSELECTION_H
@@ -66,41 +66,69 @@
     "application/x-bzip-compressed-tar": {
         "CompressionLevelDefault": 9,
         "CompressionLevelMax": 9,
-        "CompressionLevelMin": 1
+        "CompressionLevelMin": 1,
+        "SupportsTesting": true
     },
     "application/x-compressed-tar": {
         "CompressionLevelDefault": 6,
         "CompressionLevelMax": 9,
-        "CompressionLevelMin": 1
+        "CompressionLevelMin": 1,
+        "SupportsMultithreading": true,
+        "SupportsTesting": true
     },
     "application/x-lrzip-compressed-tar": {
         "CompressionLevelDefault": 1,
         "CompressionLevelMax": 9,
-        "CompressionLevelMin": 1
+        "CompressionLevelMin": 1,
+        "SupportsTesting": true
     },
     "application/x-lz4-compressed-tar": {
         "CompressionLevelDefault": 1,
         "CompressionLevelMax": 9,
-        "CompressionLevelMin": 1
+        "CompressionLevelMin": 1,
+        "SupportsTesting": true
     },
     "application/x-lzip-compressed-tar": {
         "CompressionLevelDefault": 6,
         "CompressionLevelMax": 9,
-        "CompressionLevelMin": 0
+        "CompressionLevelMin": 0,
+        "SupportsTesting": true
     },
     "application/x-lzma-compressed-tar": {
         "CompressionLevelDefault": 6,
         "CompressionLevelMax": 9,
-        "CompressionLevelMin": 0
+        "CompressionLevelMin": 0,
+        "SupportsTesting": true
+    },
+    "application/x-tar": {
+        "SupportsTesting": true
+    },
+    "application/x-tarz": {
+        "SupportsTesting": true
     },
     "application/x-tzo": {
         "CompressionLevelDefault": 5,
         "CompressionLevelMax": 9,
-        "CompressionLevelMin": 1
+        "CompressionLevelMin": 1,
+        "SupportsTesting": true
     },
     "application/x-xz-compressed-tar": {
         "CompressionLevelDefault": 6,
         "CompressionLevelMax": 9,
-        "CompressionLevelMin": 0
+        "CompressionLevelMin": 0,
+        "SupportsMultithreading": true,
+        "SupportsTesting": true
+    },
+    "application/x-zstd-compressed-tar": {
+        "CompressionLevelDefault": 3,
+        "CompressionLevelMax": 19,
+        "CompressionLevelMin": 1,
+        "CompressionMethodDefault": "Zstandard",
+        "CompressionMethods": {
+            "Zstandard": "Zstandard",
+            "Zstandard Long": "Zstandard Long"
+        },
+        "SupportsMultithreading": true,
+        "SupportsTesting": true
     }
 }
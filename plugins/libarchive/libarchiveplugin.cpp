@@ -27,6 +27,8 @@
  */
 
 #include "libarchiveplugin.h"
+#include "entryselection.h"
+#include "libarchivewriterpool.h"
 #include "ark_debug.h"
 #include "queries.h"
 
@@ -37,12 +39,19 @@
 
 #include <archive_entry.h>
 
+// Regular files up to this size are written by a LibarchiveWriterPool.
+static const qint64 maxPooledEntrySize = 1024 * 1024;
+// How much decompressed data can wait for the writer threads.
+static const qint64 maxQueuedBytes = 32 * 1024 * 1024;
+// The size of the buffer used to read the files added to an archive.
+static const int copyBufferSize = 1024 * 1024;
+
 LibarchivePlugin::LibarchivePlugin(QObject *parent, const QVariantList &args)
     : ReadWriteArchiveInterface(parent, args)
     , m_archiveReadDisk(archive_read_disk_new())
-    , m_cachedArchiveEntryCount(0)
-    , m_emitNoEntries(false)
     , m_extractedFilesSize(0)
+    , m_archiveSizeOnDisk(0)
+    , m_lastReadProgress(-1)
 {
     qCDebug(ARK) << "Initializing libarchive plugin";
     archive_read_disk_set_standard_lookup(m_archiveReadDisk.data());
@@ -70,7 +79,6 @@ bool LibarchivePlugin::list()
         emit compressionMethodFound(compMethod);
     }
 
-    m_cachedArchiveEntryCount = 0;
     m_extractedFilesSize = 0;
     m_numberOfEntries = 0;
     auto compressedArchiveSize = QFileInfo(filename()).size();
@@ -86,17 +94,15 @@ bool LibarchivePlugin::list()
             firstEntry = false;
         }
 
-        if (!m_emitNoEntries) {
-            emitEntryFromArchiveEntry(aentry);
-        }
+        emitEntryFromArchiveEntry(aentry);
 
         m_extractedFilesSize += (qlonglong)archive_entry_size(aentry);
 
         emit progress(float(archive_filter_bytes(m_archiveReader.data(), -1))/float(compressedArchiveSize));
 
-        m_cachedArchiveEntryCount++;
         archive_read_data_skip(m_archiveReader.data());
     }
+    flushEntries();
 
     if (result != ARCHIVE_EOF) {
         qCWarning(ARK) << "Could not read until the end of the archive:" << QLatin1String(archive_error_string(m_archiveReader.data()));
@@ -145,7 +151,76 @@ bool LibarchivePlugin::addComment(const QString &comment)
 
 bool LibarchivePlugin::testArchive()
 {
-    return false;
+    qCDebug(ARK) << "Testing archive";
+
+    if (!initializeReader()) {
+        return false;
+    }
+
+    m_archiveSizeOnDisk = QFileInfo(filename()).size();
+    m_lastReadProgress = -1;
+
+    // Damaged headers have no entry name, they are reported with the name of the archive.
+    const QString archiveName = QFileInfo(filename()).fileName();
+    int failures = 0;
+    bool dataReadFailed = false;
+    bool skippingDamagedBlocks = false;
+
+    struct archive_entry *entry;
+    int result = ARCHIVE_OK;
+    while (!QThread::currentThread()->isInterruptionRequested()) {
+        result = archive_read_next_header(m_archiveReader.data(), &entry);
+        if (result == ARCHIVE_RETRY) {
+            // The tar reader skips a header with a wrong checksum block by block, until
+            // it finds the next valid one. The blocks skipped are reported only once.
+            if (!skippingDamagedBlocks) {
+                emit testFailure(archiveName, QString::fromLocal8Bit(archive_error_string(m_archiveReader.data())));
+                failures++;
+                skippingDamagedBlocks = true;
+            }
+            continue;
+        }
+        skippingDamagedBlocks = false;
+        if (result != ARCHIVE_OK && result != ARCHIVE_WARN) {
+            break;
+        }
+        if (result == ARCHIVE_WARN) {
+            qCWarning(ARK) << "Warning while reading the header of" << archive_entry_pathname(entry)
+                           << ":" << archive_error_string(m_archiveReader.data());
+        }
+
+        QString errorMessage;
+        const int dataResult = testEntryData(entry, &errorMessage);
+        if (!errorMessage.isEmpty()) {
+            emit testFailure(QFile::decodeName(archive_entry_pathname(entry)), errorMessage);
+            failures++;
+        }
+
+        // The decompressor cannot go on after a fatal error, nothing more can be read.
+        if (dataResult == ARCHIVE_FATAL) {
+            dataReadFailed = true;
+            break;
+        }
+    }
+
+    if (QThread::currentThread()->isInterruptionRequested()) {
+        archive_read_close(m_archiveReader.data());
+        return false;
+    }
+
+    // A fatal error while reading the data of an entry has already been reported for that entry.
+    if (result != ARCHIVE_EOF && !dataReadFailed) {
+        emit testFailure(archiveName, QString::fromLocal8Bit(archive_error_string(m_archiveReader.data())));
+        failures++;
+    }
+
+    archive_read_close(m_archiveReader.data());
+
+    qCDebug(ARK) << "Tested archive," << failures << "errors found";
+    if (failures == 0) {
+        emit testSuccess();
+    }
+    return true;
 }
 
 bool LibarchivePlugin::hasBatchExtractionProgress() const
@@ -160,18 +235,19 @@ bool LibarchivePlugin::doKill()
 
 bool LibarchivePlugin::extractFiles(const QVector<Archive::Entry*> &files, const QString &destinationDirectory, const ExtractionOptions &options)
 {
-    qCDebug(ARK) << "Changing current directory to " << destinationDirectory;
-    QDir::setCurrent(destinationDirectory);
+    // Entries are written with absolute paths rather than relative to the
+    // current directory, which is shared by all the running jobs.
+    const QDir destDir(QDir::cleanPath(QDir(destinationDirectory).absolutePath()));
+    qCDebug(ARK) << "Extracting to" << destDir.path();
 
     const bool extractAll = files.isEmpty();
     const bool preservePaths = options.preservePaths();
     const bool removeRootNode = options.isDragAndDropEnabled();
 
     // To avoid traversing the entire archive when extracting a limited set of
-    // entries, we maintain a list of remaining entries and stop when it's
-    // empty.
-    QStringList fullPaths = entryFullPaths(files);
-    QStringList remainingFiles = entryFullPaths(files);
+    // entries, the selection keeps track of the remaining entries and the
+    // extraction stops when there are none left.
+    EntrySelection selection(files);
 
     if (!initializeReader()) {
         return false;
@@ -184,32 +260,32 @@ bool LibarchivePlugin::extractFiles(const QVector<Archive::Entry*> &files, const
 
     archive_write_disk_set_options(writer.data(), extractionFlags());
 
+    // While the reader decompresses the next entries, small files are written
+    // from other threads. Destroyed before the writer on early returns, so that
+    // the directories written by the latter get their metadata last.
+    QScopedPointer<LibarchiveWriterPool> writerPool;
+    if (QThread::idealThreadCount() > 1) {
+        writerPool.reset(new LibarchiveWriterPool(extractionFlags(), QThread::idealThreadCount() - 1, maxQueuedBytes));
+    }
+
     int entryNr = 0;
-    int totalCount = 0;
+    const int totalCount = files.size();
 
+    // When the whole archive is extracted, the progress is the amount of
+    // compressed data read so far, so that the archive is only read once.
+    m_archiveSizeOnDisk = QFileInfo(filename()).size();
+    m_lastReadProgress = -1;
     if (extractAll) {
-        if (!m_cachedArchiveEntryCount) {
-            emit progress(0);
-            //TODO: once information progress has been implemented, send
-            //feedback here that the archive is being read
-            qCDebug(ARK) << "For getting progress information, the archive will be listed once";
-            m_emitNoEntries = true;
-            list();
-            m_emitNoEntries = false;
-        }
-        totalCount = m_cachedArchiveEntryCount;
+        emit progress(0);
+        qCDebug(ARK) << "Going to extract all the entries";
     } else {
-        totalCount = files.size();
+        qCDebug(ARK) << "Going to extract" << totalCount << "entries";
     }
 
-    qCDebug(ARK) << "Going to extract" << totalCount << "entries";
-
-
     // Initialize variables.
     bool overwriteAll = false; // Whether to overwrite all files
     bool skipAll = false; // Whether to skip all files
     bool dontPromptErrors = false; // Whether to prompt for errors
-    m_currentExtractedFilesSize = 0;
     int no_entries = 0;
 
     struct archive_entry *entry;
@@ -218,12 +294,16 @@ bool LibarchivePlugin::extractFiles(const QVector<Archive::Entry*> &files, const
     // Iterate through all entries in archive.
     while (!QThread::currentThread()->isInterruptionRequested() && (archive_read_next_header(m_archiveReader.data(), &entry) == ARCHIVE_OK)) {
 
-        if (!extractAll && remainingFiles.isEmpty()) {
+        if (!extractAll && selection.isComplete()) {
             break;
         }
 
+        if (writerPool && !handleWriterFailures(writerPool.data(), &dontPromptErrors)) {
+            return false;
+        }
+
         fileBeingRenamed.clear();
-        int index = -1;
+        const Archive::Entry *selectedEntry = nullptr;
 
         // Retry with renamed entry, fire an overwrite query again
         // if the new entry also exists.
@@ -260,23 +340,19 @@ bool LibarchivePlugin::extractFiles(const QVector<Archive::Entry*> &files, const
             return false;
         }
 
+        // Find the selected entry matching this one.
+        if (!extractAll && entryName != fileBeingRenamed) {
+            selectedEntry = selection.match(entryName);
+        }
+
         // Should the entry be extracted?
         if (extractAll ||
-            remainingFiles.contains(entryName) ||
+            selectedEntry ||
             entryName == fileBeingRenamed) {
 
-            // Find the index of entry.
-            if (entryName != fileBeingRenamed) {
-                index = fullPaths.indexOf(entryName);
-            }
-            if (!extractAll && index == -1) {
-                // If entry is not found in files, skip entry.
-                continue;
-            }
-
             // entryFI is the fileinfo pointing to where the file will be
             // written from the archive.
-            QFileInfo entryFI(entryName);
+            QFileInfo entryFI(destDir, entryName);
             //qCDebug(ARK) << "setting path to " << archive_entry_pathname( entry );
 
             const QString fileWithoutPath(entryFI.fileName());
@@ -289,19 +365,26 @@ bool LibarchivePlugin::extractFiles(const QVector<Archive::Entry*> &files, const
                 Q_ASSERT(!fileWithoutPath.isEmpty());
 
                 archive_entry_copy_pathname(entry, QFile::encodeName(fileWithoutPath).constData());
-                entryFI = QFileInfo(fileWithoutPath);
+                entryFI = QFileInfo(destDir, fileWithoutPath);
 
             // OR, if the file has a rootNode attached, remove it from file path.
             } else if (!extractAll && removeRootNode && entryName != fileBeingRenamed) {
-                const QString &rootNode = files.at(index)->rootNode;
+                const QString &rootNode = selectedEntry->rootNode;
                 if (!rootNode.isEmpty()) {
                     const QString truncatedFilename(entryName.remove(entryName.indexOf(rootNode), rootNode.size()));
 
                     archive_entry_copy_pathname(entry, QFile::encodeName(truncatedFilename).constData());
-                    entryFI = QFileInfo(truncatedFilename);
+                    entryFI = QFileInfo(destDir, truncatedFilename);
                 }
             }
 
+            // The entry is written to the path in entryFI. A previous entry with the
+            // same path might still be queued, it must be on disk before going on.
+            const QByteArray entryPath = QFile::encodeName(entryFI.absoluteFilePath());
+            if (writerPool) {
+                writerPool->waitForPath(entryPath);
+            }
+
             // Check if the file about to be written already exists.
             if (!entryIsDir && entryFI.exists()) {
                 if (skipAll) {
@@ -309,7 +392,7 @@ bool LibarchivePlugin::extractFiles(const QVector<Archive::Entry*> &files, const
                     archive_entry_clear(entry);
                     continue;
                 } else if (!overwriteAll && !skipAll) {
-                    Kerfuffle::OverwriteQuery query(entryName);
+                    Kerfuffle::OverwriteQuery query(entryFI.absoluteFilePath());
                     emit userQuery(&query);
                     query.waitForResponse();
 
@@ -327,7 +410,8 @@ bool LibarchivePlugin::extractFiles(const QVector<Archive::Entry*> &files, const
                         skipAll = true;
                         continue;
                     } else if (query.responseRename()) {
-                        const QString newName(query.newFilename());
+                        // The query returns an absolute path, the entry needs one relative to the destination.
+                        const QString newName(destDir.relativeFilePath(query.newFilename()));
                         fileBeingRenamed = newName;
                         archive_entry_copy_pathname(entry, QFile::encodeName(newName).constData());
                         goto retry;
@@ -349,58 +433,76 @@ bool LibarchivePlugin::extractFiles(const QVector<Archive::Entry*> &files, const
                 }
             }
 
-            // Write the entry header and check return value.
-            const int returnCode = archive_write_header(writer.data(), entry);
-            switch (returnCode) {
-            case ARCHIVE_OK:
-                // If the whole archive is extracted and the total filesize is
-                // available, we use partial progress.
-                copyData(entryName, m_archiveReader.data(), writer.data(), (extractAll && m_extractedFilesSize));
-                break;
-
-            case ARCHIVE_FAILED:
-                qCCritical(ARK) << "archive_write_header() has returned" << returnCode
-                                << "with errno" << archive_errno(writer.data());
-
-                // If they user previously decided to ignore future errors,
-                // don't bother prompting again.
-                if (!dontPromptErrors) {
-
-                    // Ask the user if he wants to continue extraction despite an error for this entry.
-                    Kerfuffle::ContinueExtractionQuery query(QLatin1String(archive_error_string(writer.data())),
-                                                             entryName);
-                    emit userQuery(&query);
-                    query.waitForResponse();
+            // Anchor the entry (and the target of a hardlink) in the destination.
+            archive_entry_copy_pathname(entry, entryPath.constData());
+            if (archive_entry_hardlink(entry)) {
+                archive_entry_copy_hardlink(entry, QFile::encodeName(destDir.absoluteFilePath(QFile::decodeName(archive_entry_hardlink(entry)))).constData());
+            }
 
-                    if (query.responseCancelled()) {
-                        emit cancelled();
+            // If the whole archive is extracted, the progress is updated while
+            // reading the data of the entries.
+            const bool partialProgress = extractAll;
+
+            const bool usePool = writerPool &&
+                                 S_ISREG(archive_entry_mode(entry)) &&
+                                 !archive_entry_hardlink(entry) &&
+                                 archive_entry_size_is_set(entry) &&
+                                 archive_entry_size(entry) <= maxPooledEntrySize;
+
+            if (usePool) {
+                QByteArray data;
+                // An entry which can't be decompressed is not written at all.
+                if (readData(entryName, m_archiveReader.data(), &data, archive_entry_size(entry), partialProgress)) {
+                    writerPool->write(archive_entry_clone(entry), data, entryName);
+                }
+            } else {
+                if (writerPool && archive_entry_hardlink(entry)) {
+                    // The target of the link must have been written.
+                    writerPool->waitForDone();
+                }
+
+                // Write the entry header and check return value.
+                const int returnCode = archive_write_header(writer.data(), entry);
+                switch (returnCode) {
+                case ARCHIVE_OK:
+                    copyDataToDisk(entryName, m_archiveReader.data(), writer.data(), partialProgress);
+                    break;
+
+                case ARCHIVE_FAILED:
+                    qCCritical(ARK) << "archive_write_header() has returned" << returnCode
+                                    << "with errno" << archive_errno(writer.data());
+
+                    if (!continueAfterWriteError(QLatin1String(archive_error_string(writer.data())), entryName, &dontPromptErrors)) {
                         return false;
                     }
-                    dontPromptErrors = query.dontAskAgain();
+                    break;
+
+                case ARCHIVE_FATAL:
+                    qCCritical(ARK) << "archive_write_header() has returned" << returnCode
+                                    << "with errno" << archive_errno(writer.data());
+                    emit error(i18nc("@info", "Fatal error, extraction aborted."));
+                    return false;
+                default:
+                    qCDebug(ARK) << "archive_write_header() returned" << returnCode
+                                 << "which will be ignored.";
+                    break;
                 }
-                break;
-
-            case ARCHIVE_FATAL:
-                qCCritical(ARK) << "archive_write_header() has returned" << returnCode
-                                << "with errno" << archive_errno(writer.data());
-                emit error(i18nc("@info", "Fatal error, extraction aborted."));
-                return false;
-            default:
-                qCDebug(ARK) << "archive_write_header() returned" << returnCode
-                             << "which will be ignored.";
-                break;
             }
 
-            // If we only partially extract the archive and the number of
-            // archive entries is available we use a simple progress based on
-            // number of items extracted.
-            if (!extractAll && m_cachedArchiveEntryCount) {
+            // If we only partially extract the archive we use a simple progress
+            // based on number of items extracted.
+            if (!extractAll) {
                 ++entryNr;
-                emit progress(float(entryNr) / totalCount);
+                // Entries under a selected directory are not counted in totalCount.
+                emit progress(qMin(1.0f, float(entryNr) / totalCount));
+            } else {
+                emitReadProgress(m_archiveReader.data());
             }
             no_entries++;
 
-            remainingFiles.removeOne(entryName);
+            if (selectedEntry) {
+                selection.setExtracted(selectedEntry);
+            }
 
         } else {
 
@@ -411,6 +513,13 @@ bool LibarchivePlugin::extractFiles(const QVector<Archive::Entry*> &files, const
 
     } // While entries left to read in archive.
 
+    if (writerPool) {
+        writerPool->finish();
+        if (!handleWriterFailures(writerPool.data(), &dontPromptErrors)) {
+            return false;
+        }
+    }
+
     qCDebug(ARK) << "Extracted" << no_entries << "entries";
 
     return archive_read_close(m_archiveReader.data()) == ARCHIVE_OK;
@@ -473,10 +582,48 @@ void LibarchivePlugin::emitEntryFromArchiveEntry(struct archive_entry *aentry)
     auto time = static_cast<uint>(archive_entry_mtime(aentry));
     e->setProperty("timestamp", QDateTime::fromTime_t(time));
 
-    emit entry(e);
+    queueEntry(e);
     m_emittedEntries << e;
 }
 
+bool LibarchivePlugin::continueAfterWriteError(const QString &errorString, const QString &entryName, bool *dontPromptErrors)
+{
+    // If they user previously decided to ignore future errors,
+    // don't bother prompting again.
+    if (*dontPromptErrors) {
+        return true;
+    }
+
+    // Ask the user if he wants to continue extraction despite an error for this entry.
+    Kerfuffle::ContinueExtractionQuery query(errorString, entryName);
+    emit userQuery(&query);
+    query.waitForResponse();
+
+    if (query.responseCancelled()) {
+        emit cancelled();
+        return false;
+    }
+    *dontPromptErrors = query.dontAskAgain();
+
+    return true;
+}
+
+bool LibarchivePlugin::handleWriterFailures(LibarchiveWriterPool *writerPool, bool *dontPromptErrors)
+{
+    foreach (const LibarchiveWriterPool::Failure &failure, writerPool->takeFailures()) {
+        if (failure.fatal) {
+            emit error(i18nc("@info", "Fatal error, extraction aborted."));
+            return false;
+        }
+
+        if (!continueAfterWriteError(failure.errorString, failure.entryName, dontPromptErrors)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 int LibarchivePlugin::extractionFlags() const
 {
     int result = ARCHIVE_EXTRACT_TIME;
@@ -496,54 +643,170 @@ int LibarchivePlugin::extractionFlags() const
     return result;
 }
 
-void LibarchivePlugin::copyData(const QString& filename, struct archive *dest, bool partialprogress)
+void LibarchivePlugin::copyData(const QString& filename, struct archive *dest)
 {
-    char buff[10240];
     QFile file(filename);
 
     if (!file.open(QIODevice::ReadOnly)) {
         return;
     }
 
-    auto readBytes = file.read(buff, sizeof(buff));
+    QByteArray buffer(copyBufferSize, Qt::Uninitialized);
+
+    auto readBytes = file.read(buffer.data(), buffer.size());
     while (readBytes > 0) {
-        archive_write_data(dest, buff, static_cast<size_t>(readBytes));
-        if (archive_errno(dest) != ARCHIVE_OK) {
+        if (archive_write_data(dest, buffer.constData(), static_cast<size_t>(readBytes)) < 0) {
             qCCritical(ARK) << "Error while writing" << filename << ":" << archive_error_string(dest)
                             << "(error no =" << archive_errno(dest) << ')';
             return;
         }
 
+        readBytes = file.read(buffer.data(), buffer.size());
+    }
+
+    file.close();
+}
+
+void LibarchivePlugin::emitReadProgress(struct archive *source)
+{
+    if (m_archiveSizeOnDisk <= 0) {
+        return;
+    }
+
+    // Only emit when the percentage changes, not for every block.
+    const int readProgress = static_cast<int>(qMin<qint64>(1000, 1000 * archive_filter_bytes(source, -1) / m_archiveSizeOnDisk));
+    if (readProgress != m_lastReadProgress) {
+        m_lastReadProgress = readProgress;
+        emit progress(readProgress / 1000.0);
+    }
+}
+
+bool LibarchivePlugin::readData(const QString& filename, struct archive *source, QByteArray *data, qint64 size, bool partialprogress)
+{
+    // Sparse regions are not returned by libarchive, they stay zeroed.
+    *data = QByteArray(static_cast<int>(size), '\0');
+
+    const void *block;
+    size_t blockSize;
+    int64_t offset;
+    int result;
+    while ((result = archive_read_data_block(source, &block, &blockSize, &offset)) == ARCHIVE_OK) {
+        if (offset < 0 || offset + static_cast<int64_t>(blockSize) > size) {
+            qCWarning(ARK) << "Ignoring data beyond the size of" << filename;
+            continue;
+        }
+
+        memcpy(data->data() + offset, block, blockSize);
+
         if (partialprogress) {
-            m_currentExtractedFilesSize += readBytes;
-            emit progress(float(m_currentExtractedFilesSize) / m_extractedFilesSize);
+            emitReadProgress(source);
         }
+    }
 
-        readBytes = file.read(buff, sizeof(buff));
+    if (result != ARCHIVE_EOF) {
+        qCCritical(ARK) << "Error while extracting" << filename << ":" << archive_error_string(source)
+                        << "(error no =" << archive_errno(source) << ')';
+        return false;
     }
 
-    file.close();
+    return true;
 }
 
-void LibarchivePlugin::copyData(const QString& filename, struct archive *source, struct archive *dest, bool partialprogress)
+int LibarchivePlugin::testEntryData(struct archive_entry *entry, QString *errorMessage)
 {
-    char buff[10240];
+    // The blocks are only decompressed, which also verifies the checksums of the
+    // compressed stream, for example the CRCs of xz and bzip2 blocks.
+    const void *block;
+    size_t blockSize;
+    int64_t offset;
+    int64_t readSize = 0;
+    int result;
+    while ((result = archive_read_data_block(m_archiveReader.data(), &block, &blockSize, &offset)) == ARCHIVE_OK) {
+        readSize = qMax(readSize, offset + static_cast<int64_t>(blockSize));
+        emitReadProgress(m_archiveReader.data());
+
+        if (QThread::currentThread()->isInterruptionRequested()) {
+            return ARCHIVE_OK;
+        }
+    }
 
-    auto readBytes = archive_read_data(source, buff, sizeof(buff));
-    while (readBytes > 0) {
-        archive_write_data(dest, buff, static_cast<size_t>(readBytes));
-        if (archive_errno(dest) != ARCHIVE_OK) {
+    if (result != ARCHIVE_EOF) {
+        *errorMessage = QString::fromLocal8Bit(archive_error_string(m_archiveReader.data()));
+        return result;
+    }
+
+    // Sparse files can end with a hole, and hardlinks have no data of their own.
+    if (archive_entry_filetype(entry) == AE_IFREG && archive_entry_size_is_set(entry) && !archive_entry_hardlink(entry)
+            && archive_entry_sparse_count(entry) == 0 && readSize != archive_entry_size(entry)) {
+        *errorMessage = i18nc("@info", "The entry has %1 bytes of data instead of %2.",
+                              static_cast<qlonglong>(readSize), static_cast<qlonglong>(archive_entry_size(entry)));
+    }
+
+    return result;
+}
+
+void LibarchivePlugin::copyDataToDisk(const QString& filename, struct archive *source, struct archive *dest, bool partialprogress)
+{
+    // The blocks go from the decompressor to the file without being copied,
+    // and the gaps between them are left as holes in the file.
+    const void *block;
+    size_t blockSize;
+    int64_t offset;
+    int result;
+    while ((result = archive_read_data_block(source, &block, &blockSize, &offset)) == ARCHIVE_OK) {
+        if (archive_write_data_block(dest, block, blockSize, offset) < ARCHIVE_WARN) {
             qCCritical(ARK) << "Error while extracting" << filename << ":" << archive_error_string(dest)
                             << "(error no =" << archive_errno(dest) << ')';
             return;
         }
 
         if (partialprogress) {
-            m_currentExtractedFilesSize += readBytes;
-            emit progress(float(m_currentExtractedFilesSize) / m_extractedFilesSize);
+            emitReadProgress(source);
+        }
+    }
+
+    if (result != ARCHIVE_EOF) {
+        qCCritical(ARK) << "Error while extracting" << filename << ":" << archive_error_string(source)
+                        << "(error no =" << archive_errno(source) << ')';
+    }
+}
+
+void LibarchivePlugin::copyData(const QString& filename, struct archive *source, struct archive *dest, bool partialprogress)
+{
+    static const char zeros[16384] = {};
+
+    const void *block;
+    size_t blockSize;
+    int64_t offset;
+    int64_t position = 0;
+    int result;
+    while ((result = archive_read_data_block(source, &block, &blockSize, &offset)) == ARCHIVE_OK) {
+        // Archive writers don't support holes, sparse regions are written as zeros.
+        while (position < offset) {
+            const auto zerosSize = static_cast<size_t>(qMin<int64_t>(sizeof(zeros), offset - position));
+            if (archive_write_data(dest, zeros, zerosSize) < 0) {
+                qCCritical(ARK) << "Error while writing" << filename << ":" << archive_error_string(dest)
+                                << "(error no =" << archive_errno(dest) << ')';
+                return;
+            }
+            position += zerosSize;
+        }
+
+        if (blockSize > 0 && archive_write_data(dest, block, blockSize) < 0) {
+            qCCritical(ARK) << "Error while writing" << filename << ":" << archive_error_string(dest)
+                            << "(error no =" << archive_errno(dest) << ')';
+            return;
+        }
+        position = offset + static_cast<int64_t>(blockSize);
+
+        if (partialprogress) {
+            emitReadProgress(source);
         }
+    }
 
-        readBytes = archive_read_data(source, buff, sizeof(buff));
+    if (result != ARCHIVE_EOF) {
+        qCCritical(ARK) << "Error while reading" << filename << ":" << archive_error_string(source)
+                        << "(error no =" << archive_errno(source) << ')';
     }
 }
 
@@ -567,6 +830,8 @@ QString LibarchivePlugin::convertCompressionName(const QString &method)
         return QStringLiteral("lzop");
     } else if (method == QLatin1String("lzma")) {
         return QStringLiteral("LZMA");
+    } else if (method == QLatin1String("zstd")) {
+        return QStringLiteral("Zstandard");
     }
     return QString();
 }
@@ -36,6 +36,8 @@
 
 using namespace Kerfuffle;
 
+class LibarchiveWriterPool;
+
 class LibarchivePlugin : public ReadWriteArchiveInterface
 {
     Q_OBJECT
@@ -82,20 +84,57 @@ protected:
 
     bool initializeReader();
     void emitEntryFromArchiveEntry(struct archive_entry *entry);
-    void copyData(const QString& filename, struct archive *dest, bool partialprogress = true);
+    void copyData(const QString& filename, struct archive *dest);
     void copyData(const QString& filename, struct archive *source, struct archive *dest, bool partialprogress = true);
 
+    /**
+     * Same as copyData(), for a @p dest created by archive_write_disk_new().
+     */
+    void copyDataToDisk(const QString& filename, struct archive *source, struct archive *dest, bool partialprogress = true);
+
+    /**
+     * Reads the @p size bytes of data of the current entry of @p source into @p data.
+     * @return Whether the data could be decompressed.
+     */
+    bool readData(const QString& filename, struct archive *source, QByteArray *data, qint64 size, bool partialprogress = true);
+
+    /**
+     * Reads the data of the current @p entry of the archive reader without writing it anywhere.
+     *
+     * @return The result of the last read. @p errorMessage is set if the data could
+     * not be read or if its size is wrong.
+     */
+    int testEntryData(struct archive_entry *entry, QString *errorMessage);
+
+    /**
+     * Emits the progress of an extraction as the part of the archive file read by @p source.
+     */
+    void emitReadProgress(struct archive *source);
+
     ArchiveRead m_archiveReader;
     ArchiveRead m_archiveReadDisk;
 
 private:
     int extractionFlags() const;
+
+    /**
+     * Asks the user whether to go on after @p entryName could not be written.
+     *
+     * @return False if the extraction has to be aborted.
+     */
+    bool continueAfterWriteError(const QString &errorString, const QString &entryName, bool *dontPromptErrors);
+
+    /**
+     * Reports the entries that @p writerPool could not write.
+     *
+     * @return False if the extraction has to be aborted.
+     */
+    bool handleWriterFailures(LibarchiveWriterPool *writerPool, bool *dontPromptErrors);
     QString convertCompressionName(const QString &method);
 
-    int m_cachedArchiveEntryCount;
-    qlonglong m_currentExtractedFilesSize;
-    bool m_emitNoEntries;
     qlonglong m_extractedFilesSize;
+    qint64 m_archiveSizeOnDisk;
+    int m_lastReadProgress;
     QVector<Archive::Entry*> m_emittedEntries;
 };
 
@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2026 The Ark developers <kde-utils-devel@kde.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES ( INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION ) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * ( INCLUDING NEGLIGENCE OR OTHERWISE ) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "libarchivewriterpool.h"
+#include "ark_debug.h"
+
+#include <QFile>
+#include <QMutexLocker>
+#include <QRunnable>
+
+#include <archive.h>
+#include <archive_entry.h>
+
+class LibarchiveWriterPool::WriteTask : public QRunnable
+{
+public:
+    WriteTask(LibarchiveWriterPool *pool, struct archive_entry *entry, const QByteArray &data, const QString &entryName)
+        : m_pool(pool)
+        , m_entry(entry)
+        , m_data(data)
+        , m_entryName(entryName)
+    {
+    }
+
+    void run() override
+    {
+        m_pool->writeEntry(m_entry, m_data, m_entryName);
+    }
+
+private:
+    LibarchiveWriterPool *m_pool;
+    struct archive_entry *m_entry;
+    QByteArray m_data;
+    QString m_entryName;
+};
+
+LibarchiveWriterPool::LibarchiveWriterPool(int flags, int threadCount, qint64 maxQueuedBytes)
+    : m_flags(flags)
+    , m_maxQueuedBytes(maxQueuedBytes)
+    , m_queuedBytes(0)
+    , m_finished(false)
+{
+    m_threadPool.setMaxThreadCount(qMax(1, threadCount));
+}
+
+LibarchiveWriterPool::~LibarchiveWriterPool()
+{
+    finish();
+}
+
+void LibarchiveWriterPool::write(struct archive_entry *entry, const QByteArray &data, const QString &entryName)
+{
+    Q_ASSERT(!m_finished);
+
+    {
+        QMutexLocker locker(&m_mutex);
+
+        // A single entry larger than the limit is accepted once the queue is empty.
+        while (m_queuedBytes > 0 && m_queuedBytes + data.size() > m_maxQueuedBytes) {
+            m_entryWritten.wait(&m_mutex);
+        }
+
+        m_queuedBytes += data.size();
+        m_queuedPaths.insert(QByteArray(archive_entry_pathname(entry)));
+    }
+
+    m_threadPool.start(new WriteTask(this, entry, data, entryName));
+}
+
+void LibarchiveWriterPool::waitForPath(const QByteArray &pathname)
+{
+    QMutexLocker locker(&m_mutex);
+    while (m_queuedPaths.contains(pathname)) {
+        m_entryWritten.wait(&m_mutex);
+    }
+}
+
+void LibarchiveWriterPool::waitForDone()
+{
+    m_threadPool.waitForDone();
+}
+
+QVector<LibarchiveWriterPool::Failure> LibarchiveWriterPool::takeFailures()
+{
+    QMutexLocker locker(&m_mutex);
+    QVector<Failure> failures;
+    failures.swap(m_failures);
+    return failures;
+}
+
+bool LibarchiveWriterPool::finish()
+{
+    if (m_finished) {
+        return true;
+    }
+
+    waitForDone();
+    m_finished = true;
+
+    bool result = true;
+    foreach (struct archive *writer, m_writers) {
+        if (archive_write_close(writer) != ARCHIVE_OK) {
+            qCWarning(ARK) << "Could not close the disk writer:" << archive_error_string(writer);
+            result = false;
+        }
+        archive_write_free(writer);
+    }
+    m_writers.clear();
+    m_idleWriters.clear();
+
+    return result;
+}
+
+void LibarchiveWriterPool::writeEntry(struct archive_entry *entry, const QByteArray &data, const QString &entryName)
+{
+    struct archive *writer = acquireWriter();
+    const QByteArray pathname(archive_entry_pathname(entry));
+
+    Failure failure;
+    failure.fatal = false;
+
+    int returnCode = writer ? archive_write_header(writer, entry) : ARCHIVE_FATAL;
+    if (returnCode == ARCHIVE_OK && !data.isEmpty()) {
+        if (archive_write_data(writer, data.constData(), static_cast<size_t>(data.size())) < 0) {
+            returnCode = ARCHIVE_FAILED;
+        }
+    }
+    if (returnCode == ARCHIVE_OK) {
+        returnCode = archive_write_finish_entry(writer);
+    }
+
+    if (returnCode == ARCHIVE_FAILED || returnCode == ARCHIVE_FATAL) {
+        qCCritical(ARK) << "Error while extracting" << entryName << ":"
+                        << (writer ? archive_error_string(writer) : "no disk writer");
+        failure.entryName = entryName;
+        failure.errorString = writer ? QString::fromLocal8Bit(archive_error_string(writer)) : QString();
+        failure.fatal = (returnCode == ARCHIVE_FATAL);
+    }
+
+    archive_entry_free(entry);
+
+    QMutexLocker locker(&m_mutex);
+    if (writer) {
+        m_idleWriters.append(writer);
+    }
+    if (!failure.entryName.isEmpty()) {
+        m_failures.append(failure);
+    }
+    m_queuedBytes -= data.size();
+    m_queuedPaths.remove(pathname);
+    m_entryWritten.wakeAll();
+}
+
+struct archive *LibarchiveWriterPool::acquireWriter()
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_idleWriters.isEmpty()) {
+        return m_idleWriters.takeLast();
+    }
+
+    struct archive *writer = archive_write_disk_new();
+    if (!writer) {
+        return nullptr;
+    }
+
+    archive_write_disk_set_options(writer, m_flags);
+    m_writers.append(writer);
+
+    return writer;
+}
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2026 The Ark developers <kde-utils-devel@kde.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES ( INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION ) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * ( INCLUDING NEGLIGENCE OR OTHERWISE ) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LIBARCHIVEWRITERPOOL_H
+#define LIBARCHIVEWRITERPOOL_H
+
+#include <QByteArray>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include <QThreadPool>
+#include <QVector>
+#include <QWaitCondition>
+
+struct archive;
+struct archive_entry;
+
+/**
+ * Writes archive entries to disk from a pool of threads.
+ *
+ * The thread reading the archive queues entries whose data has already been
+ * decompressed, and goes on with the next ones while they are written. Each
+ * writer thread uses its own archive_write_disk handle.
+ *
+ * The amount of queued data is bounded: write() blocks until enough of
+ * the previously queued entries have been written.
+ */
+class LibarchiveWriterPool
+{
+public:
+    struct Failure
+    {
+        QString entryName;
+        QString errorString;
+        bool fatal;
+    };
+
+    /**
+     * @param flags The options of the archive_write_disk handles.
+     * @param threadCount The number of writer threads.
+     * @param maxQueuedBytes How much data can be waiting to be written.
+     */
+    LibarchiveWriterPool(int flags, int threadCount, qint64 maxQueuedBytes);
+
+    /**
+     * Waits for the queued entries to be written, see finish().
+     */
+    ~LibarchiveWriterPool();
+
+    /**
+     * Queues @p entry to be written with @p data as content.
+     *
+     * The pool takes the ownership of @p entry, which must be a copy not used
+     * by the reader. @p entryName is the name used to report failures.
+     */
+    void write(struct archive_entry *entry, const QByteArray &data, const QString &entryName);
+
+    /**
+     * Blocks until no queued entry is going to be written to @p pathname.
+     *
+     * Entries are written in any order. The caller must wait before checking
+     * whether a file exists or writing it again.
+     */
+    void waitForPath(const QByteArray &pathname);
+
+    /**
+     * Blocks until all the queued entries have been written.
+     */
+    void waitForDone();
+
+    /**
+     * @return The failures that happened since the last call, in no particular order.
+     */
+    QVector<Failure> takeFailures();
+
+    /**
+     * Waits for the queued entries to be written and closes the writer handles,
+     * which restores the metadata of the written directories.
+     *
+     * @return Whether all the handles were closed successfully.
+     */
+    bool finish();
+
+private:
+    class WriteTask;
+
+    void writeEntry(struct archive_entry *entry, const QByteArray &data, const QString &entryName);
+    struct archive *acquireWriter();
+
+    QThreadPool m_threadPool;
+    QMutex m_mutex;
+    QWaitCondition m_entryWritten;
+
+    const int m_flags;
+    const qint64 m_maxQueuedBytes;
+    qint64 m_queuedBytes;
+    QSet<QByteArray> m_queuedPaths;
+
+    QVector<struct archive*> m_writers;
+    QVector<struct archive*> m_idleWriters;
+    QVector<Failure> m_failures;
+    bool m_finished;
+};
+
+#endif // LIBARCHIVEWRITERPOOL_H
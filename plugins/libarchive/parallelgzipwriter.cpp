@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2026 The Ark developers <kde-utils-devel@kde.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES ( INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION ) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * ( INCLUDING NEGLIGENCE OR OTHERWISE ) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "parallelgzipwriter.h"
+#include "ark_debug.h"
+
+#include <QIODevice>
+#include <QMutexLocker>
+#include <QRunnable>
+
+#include <zlib.h>
+
+// The amount of data compressed into each gzip member. Smaller blocks spread
+// better over the threads, larger ones compress better.
+static const int blockSize = 1024 * 1024;
+
+class ParallelGzipWriter::CompressTask : public QRunnable
+{
+public:
+    CompressTask(ParallelGzipWriter *writer, int index, const QByteArray &block)
+        : m_writer(writer)
+        , m_index(index)
+        , m_block(block)
+    {
+    }
+
+    void run() override
+    {
+        m_writer->compressBlock(m_index, m_block);
+    }
+
+private:
+    ParallelGzipWriter *m_writer;
+    int m_index;
+    QByteArray m_block;
+};
+
+ParallelGzipWriter::ParallelGzipWriter(QIODevice *device, int threadCount, int level)
+    : m_device(device)
+    , m_level(level)
+    , m_maxQueuedBlocks(2 * qMax(1, threadCount))
+    , m_queuedBlocks(0)
+    , m_nextWrittenBlock(0)
+    , m_failed(false)
+{
+    m_threadPool.setMaxThreadCount(qMax(1, threadCount));
+    m_block.reserve(blockSize);
+}
+
+ParallelGzipWriter::~ParallelGzipWriter()
+{
+    m_threadPool.waitForDone();
+}
+
+bool ParallelGzipWriter::write(const char *data, qint64 size)
+{
+    while (size > 0) {
+        const int chunkSize = static_cast<int>(qMin<qint64>(size, blockSize - m_block.size()));
+        m_block.append(data, chunkSize);
+        data += chunkSize;
+        size -= chunkSize;
+
+        if (m_block.size() == blockSize) {
+            if (!writeMembers(false)) {
+                return false;
+            }
+            queueBlock();
+        }
+    }
+
+    return true;
+}
+
+bool ParallelGzipWriter::close()
+{
+    // An empty stream still needs a member to be a valid gzip file.
+    if (!m_block.isEmpty() || m_nextWrittenBlock + m_queuedBlocks == 0) {
+        if (!writeMembers(false)) {
+            return false;
+        }
+        queueBlock();
+    }
+
+    return writeMembers(true);
+}
+
+void ParallelGzipWriter::queueBlock()
+{
+    int index;
+    {
+        QMutexLocker locker(&m_mutex);
+        index = m_nextWrittenBlock + m_queuedBlocks;
+        m_queuedBlocks++;
+    }
+
+    m_threadPool.start(new CompressTask(this, index, m_block));
+    m_block = QByteArray();
+    m_block.reserve(blockSize);
+}
+
+bool ParallelGzipWriter::writeMembers(bool waitForAll)
+{
+    forever {
+        QByteArray member;
+        {
+            QMutexLocker locker(&m_mutex);
+            // Without waiting for all the blocks, wait only until there is room for a new one.
+            const int maxQueuedBlocks = waitForAll ? 1 : m_maxQueuedBlocks;
+            while (m_queuedBlocks >= maxQueuedBlocks && !m_members.contains(m_nextWrittenBlock) && !m_failed) {
+                m_blockCompressed.wait(&m_mutex);
+            }
+
+            if (m_failed) {
+                return false;
+            }
+            if (!m_members.contains(m_nextWrittenBlock)) {
+                return true;
+            }
+
+            member = m_members.take(m_nextWrittenBlock);
+            m_nextWrittenBlock++;
+            m_queuedBlocks--;
+        }
+
+        if (m_device->write(member) != member.size()) {
+            qCCritical(ARK) << "Could not write the compressed data:" << m_device->errorString();
+            QMutexLocker locker(&m_mutex);
+            m_failed = true;
+            return false;
+        }
+    }
+}
+
+void ParallelGzipWriter::compressBlock(int index, const QByteArray &block)
+{
+    z_stream stream;
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+    stream.opaque = Z_NULL;
+
+    // A window size of 15 + 16 makes zlib write a gzip header and trailer.
+    QByteArray member;
+    bool compressed = deflateInit2(&stream, m_level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+    if (compressed) {
+        member.resize(static_cast<int>(deflateBound(&stream, static_cast<uLong>(block.size()))));
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(block.constData()));
+        stream.avail_in = static_cast<uInt>(block.size());
+        stream.next_out = reinterpret_cast<Bytef*>(member.data());
+        stream.avail_out = static_cast<uInt>(member.size());
+
+        compressed = deflate(&stream, Z_FINISH) == Z_STREAM_END;
+        member.resize(static_cast<int>(stream.total_out));
+        deflateEnd(&stream);
+    }
+
+    QMutexLocker locker(&m_mutex);
+    if (compressed) {
+        m_members.insert(index, member);
+    } else {
+        qCCritical(ARK) << "Could not compress block" << index << ":" << (stream.msg ? stream.msg : "");
+        m_failed = true;
+    }
+    m_blockCompressed.wakeAll();
+}
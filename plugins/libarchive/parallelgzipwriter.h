@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2026 The Ark developers <kde-utils-devel@kde.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES ( INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION ) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * ( INCLUDING NEGLIGENCE OR OTHERWISE ) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PARALLELGZIPWRITER_H
+#define PARALLELGZIPWRITER_H
+
+#include <QByteArray>
+#include <QMap>
+#include <QMutex>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+class QIODevice;
+
+/**
+ * Compresses a stream to gzip from a pool of threads.
+ *
+ * The data is split in blocks which are compressed independently, each one
+ * into a complete gzip member. The members are written to the device in
+ * order, so that the result is a standard multi-member gzip file which
+ * every gzip decoder can read.
+ *
+ * The number of blocks being compressed is bounded: write() blocks until
+ * the oldest ones have been written.
+ */
+class ParallelGzipWriter
+{
+public:
+    /**
+     * @param device The device the gzip members are written to.
+     * @param threadCount The number of compressing threads.
+     * @param level The zlib compression level, or -1 for the default one.
+     */
+    ParallelGzipWriter(QIODevice *device, int threadCount, int level);
+
+    /**
+     * Waits for the queued blocks, without writing them.
+     */
+    ~ParallelGzipWriter();
+
+    /**
+     * Queues @p size bytes of @p data to be compressed.
+     *
+     * @return Whether the data compressed so far could be written.
+     */
+    bool write(const char *data, qint64 size);
+
+    /**
+     * Compresses the remaining data and writes all the members.
+     *
+     * @return Whether all the members could be written.
+     */
+    bool close();
+
+private:
+    class CompressTask;
+
+    void compressBlock(int index, const QByteArray &block);
+    void queueBlock();
+
+    /**
+     * Writes the members compressed so far, in order. Waits for all the queued
+     * blocks if @p waitForAll is true, else only until a block can be queued.
+     */
+    bool writeMembers(bool waitForAll);
+
+    QThreadPool m_threadPool;
+    QMutex m_mutex;
+    QWaitCondition m_blockCompressed;
+
+    QIODevice *m_device;
+    const int m_level;
+    const int m_maxQueuedBlocks;
+
+    QByteArray m_block;
+    int m_queuedBlocks;
+    int m_nextWrittenBlock;
+    QMap<int, QByteArray> m_members;
+    bool m_failed;
+};
+
+#endif // PARALLELGZIPWRITER_H
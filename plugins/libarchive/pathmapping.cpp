@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2026 The Ark developers <kde-utils-devel@kde.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES ( INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION ) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * ( INCLUDING NEGLIGENCE OR OTHERWISE ) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "pathmapping.h"
+
+#include <QFile>
+
+PathMapping::PathMapping(DirectoryRule rule)
+    : m_rule(rule)
+{
+}
+
+void PathMapping::insert(const QString &oldPath, const QString &newPath)
+{
+    const QByteArray path = QFile::encodeName(oldPath);
+    const QByteArray mappedPath = newPath.toUtf8();
+    m_paths.insert(path, mappedPath);
+
+    if (m_rule == Subtree && path.endsWith('/')) {
+        m_directories.insert(path.left(path.size() - 1), mappedPath);
+    }
+}
+
+bool PathMapping::isEmpty() const
+{
+    return m_paths.isEmpty();
+}
+
+bool PathMapping::contains(const QByteArray &path) const
+{
+    return lookup(path, nullptr);
+}
+
+QByteArray PathMapping::newPath(const QByteArray &path) const
+{
+    QByteArray mappedPath;
+    lookup(path, &mappedPath);
+    return mappedPath;
+}
+
+bool PathMapping::lookup(const QByteArray &path, QByteArray *newPath) const
+{
+    const auto it = m_paths.constFind(path);
+    if (it != m_paths.constEnd()) {
+        if (newPath) {
+            *newPath = it.value();
+        }
+        return true;
+    }
+
+    if (m_directories.isEmpty()) {
+        return false;
+    }
+
+    // Look for a mapped ancestor directory.
+    const int end = path.endsWith('/') ? path.size() - 2 : path.size() - 1;
+    int slash = path.lastIndexOf('/', end);
+    while (slash > 0) {
+        const auto dir = m_directories.constFind(QByteArray::fromRawData(path.constData(), slash));
+        if (dir != m_directories.constEnd()) {
+            if (newPath && !dir.value().isEmpty()) {
+                *newPath = dir.value();
+                if (!newPath->endsWith('/')) {
+                    newPath->append('/');
+                }
+                newPath->append(path.mid(slash + 1));
+            }
+            return true;
+        }
+        slash = path.lastIndexOf('/', slash - 1);
+    }
+
+    return false;
+}
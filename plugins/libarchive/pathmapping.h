@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2026 The Ark developers <kde-utils-devel@kde.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES ( INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION ) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * ( INCLUDING NEGLIGENCE OR OTHERWISE ) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PATHMAPPING_H
+#define PATHMAPPING_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+
+/**
+ * The paths of the entries modified while rewriting an archive, and their
+ * new paths, indexed for matching the paths read from the archive.
+ *
+ * With the Subtree rule, a mapped directory also maps all the paths under
+ * it, which keep their position relative to the new directory path. The
+ * cost of a lookup does not depend on the number of mapped paths.
+ */
+class PathMapping
+{
+public:
+    enum DirectoryRule {
+        ExactPaths,
+        Subtree
+    };
+
+    explicit PathMapping(DirectoryRule rule = ExactPaths);
+
+    /**
+     * Maps @p oldPath to @p newPath, which is empty for removed entries.
+     */
+    void insert(const QString &oldPath, const QString &newPath = QString());
+
+    bool isEmpty() const;
+
+    /**
+     * @return Whether @p path, as read from the archive, is mapped.
+     */
+    bool contains(const QByteArray &path) const;
+
+    /**
+     * @return The new path of @p path, which is empty if @p path is removed or not mapped.
+     */
+    QByteArray newPath(const QByteArray &path) const;
+
+private:
+    bool lookup(const QByteArray &path, QByteArray *newPath) const;
+
+    DirectoryRule m_rule;
+    QHash<QByteArray, QByteArray> m_paths;
+    // The mapped directories, by path without trailing slash.
+    QHash<QByteArray, QByteArray> m_directories;
+};
+
+#endif // PATHMAPPING_H
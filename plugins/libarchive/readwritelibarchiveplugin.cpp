@@ -27,16 +27,34 @@
  */
 
 #include "readwritelibarchiveplugin.h"
+#include "pathmapping.h"
 #include "ark_debug.h"
 
 #include <KLocalizedString>
 #include <KPluginFactory>
 
-#include <QDirIterator>
 #include <QSaveFile>
 #include <QThread>
 
 #include <archive_entry.h>
+#include <zlib.h>
+
+#include <cstring>
+
+// The size of the buffer used to copy unchanged entries between archives.
+static const qint64 rawCopyBufferSize = 1024 * 1024;
+
+static ssize_t writeGzipCallback(struct archive *, void *clientData, const void *buffer, size_t length)
+{
+    auto writer = static_cast<ParallelGzipWriter*>(clientData);
+    return writer->write(static_cast<const char*>(buffer), static_cast<qint64>(length)) ? static_cast<ssize_t>(length) : -1;
+}
+
+static int closeGzipCallback(struct archive *, void *clientData)
+{
+    auto writer = static_cast<ParallelGzipWriter*>(clientData);
+    return writer->close() ? ARCHIVE_OK : ARCHIVE_FATAL;
+}
 
 K_PLUGIN_FACTORY_WITH_JSON(ReadWriteLibarchivePluginFactory, "kerfuffle_libarchive.json", registerPlugin<ReadWriteLibarchivePlugin>();)
 
@@ -75,48 +93,18 @@ bool ReadWriteLibarchivePlugin::addFiles(const QVector<Archive::Entry*> &files,
                                     ? QString()
                                     : destination->fullPath();
 
-    foreach(Archive::Entry *selectedFile, files) {
+    const FileManifest manifest = takeFileManifest(files);
+    foreach (const FileManifest::File &file, manifest.files()) {
         if (QThread::currentThread()->isInterruptionRequested()) {
             break;
         }
 
-        if (!writeFile(selectedFile->fullPath(), destinationPath)) {
+        if (!writeFile(file, destinationPath)) {
             finish(false);
             return false;
         }
         no_entries++;
         emit progress(float(no_entries)/float(totalCount));
-
-        // For directories, write all subfiles/folders.
-        const QString &fullPath = selectedFile->fullPath();
-        if (QFileInfo(fullPath).isDir()) {
-            QDirIterator it(fullPath,
-                            QDir::AllEntries | QDir::Readable |
-                            QDir::Hidden | QDir::NoDotAndDotDot,
-                            QDirIterator::Subdirectories);
-
-            while (!QThread::currentThread()->isInterruptionRequested() && it.hasNext()) {
-                QString path = it.next();
-
-                if ((it.fileName() == QLatin1String("..")) ||
-                    (it.fileName() == QLatin1String("."))) {
-                    continue;
-                }
-
-                const bool isRealDir = it.fileInfo().isDir() && !it.fileInfo().isSymLink();
-
-                if (isRealDir) {
-                    path.append(QLatin1Char('/'));
-                }
-
-                if (!writeFile(path, destinationPath)) {
-                    finish(false);
-                    return false;
-                }
-                no_entries++;
-                emit progress(float(no_entries)/float(totalCount));
-            }
-        }
     }
     qCDebug(ARK) << "Added" << no_entries << "new entries to archive";
 
@@ -139,15 +127,13 @@ bool ReadWriteLibarchivePlugin::addFiles(const QVector<Archive::Entry*> &files,
 
 bool ReadWriteLibarchivePlugin::moveFiles(const QVector<Archive::Entry*> &files, Archive::Entry *destination, const CompressionOptions &options)
 {
-    Q_UNUSED(options);
-
     qCDebug(ARK) << "Moving" << files.size() << "entries";
 
     if (!initializeReader()) {
         return false;
     }
 
-    if (!initializeWriter()) {
+    if (!initializeWriter(false, options)) {
         return false;
     }
 
@@ -169,15 +155,13 @@ bool ReadWriteLibarchivePlugin::moveFiles(const QVector<Archive::Entry*> &files,
 
 bool ReadWriteLibarchivePlugin::copyFiles(const QVector<Archive::Entry*> &files, Archive::Entry *destination, const CompressionOptions &options)
 {
-    Q_UNUSED(options);
-
     qCDebug(ARK) << "Copying" << files.size() << "entries";
 
     if (!initializeReader()) {
         return false;
     }
 
-    if (!initializeWriter()) {
+    if (!initializeWriter(false, options)) {
         return false;
     }
 
@@ -235,6 +219,7 @@ bool ReadWriteLibarchivePlugin::initializeWriter(const bool creatingNewFile, con
     }
 
     m_archiveWriter.reset(archive_write_new());
+    m_gzipWriter.reset();
     if (!(m_archiveWriter.data())) {
         emit error(i18n("The archive writer could not be initialized."));
         return false;
@@ -243,17 +228,30 @@ bool ReadWriteLibarchivePlugin::initializeWriter(const bool creatingNewFile, con
     // pax_restricted is the libarchive default, let's go with that.
     archive_write_set_format_pax_restricted(m_archiveWriter.data());
 
+    // The entries of an uncompressed tar which are not modified can be copied
+    // as they are. The data written by libarchive then must not be held back
+    // in its blocks, so that it stays in order with the copied data.
+    m_copyRawEntries = !creatingNewFile && archive_filter_code(m_archiveReader.data(), 0) == ARCHIVE_FILTER_NONE;
+    if (m_copyRawEntries) {
+        archive_write_set_bytes_per_block(m_archiveWriter.data(), 0);
+    }
+
     if (creatingNewFile) {
         if (!initializeNewFileWriterFilters(options)) {
             return false;
         }
     } else {
-        if (!initializeWriterFilters()) {
+        if (!initializeWriterFilters(options)) {
             return false;
         }
     }
 
-    if (archive_write_open_fd(m_archiveWriter.data(), m_tempFile.handle()) != ARCHIVE_OK) {
+    setFilterThreads(options);
+
+    const int ret = m_gzipWriter
+                    ? archive_write_open(m_archiveWriter.data(), m_gzipWriter.data(), nullptr, writeGzipCallback, closeGzipCallback)
+                    : archive_write_open_fd(m_archiveWriter.data(), m_tempFile.handle());
+    if (ret != ARCHIVE_OK) {
         emit error(i18nc("@info", "Could not open the archive for writing entries."));
         return false;
     }
@@ -261,13 +259,13 @@ bool ReadWriteLibarchivePlugin::initializeWriter(const bool creatingNewFile, con
     return true;
 }
 
-bool ReadWriteLibarchivePlugin::initializeWriterFilters()
+bool ReadWriteLibarchivePlugin::initializeWriterFilters(const CompressionOptions &options)
 {
     int ret;
     bool requiresExecutable = false;
     switch (archive_filter_code(m_archiveReader.data(), 0)) {
     case ARCHIVE_FILTER_GZIP:
-        ret = archive_write_add_filter_gzip(m_archiveWriter.data());
+        ret = addGzipFilter(options, Z_DEFAULT_COMPRESSION);
         break;
     case ARCHIVE_FILTER_BZIP2:
         ret = archive_write_add_filter_bzip2(m_archiveWriter.data());
@@ -294,6 +292,11 @@ bool ReadWriteLibarchivePlugin::initializeWriterFilters()
     case ARCHIVE_FILTER_LZ4:
         ret = archive_write_add_filter_lz4(m_archiveWriter.data());
         break;
+#ifdef ARCHIVE_FILTER_ZSTD
+    case ARCHIVE_FILTER_ZSTD:
+        ret = archive_write_add_filter_zstd(m_archiveWriter.data());
+        break;
+#endif
     case ARCHIVE_FILTER_NONE:
         ret = archive_write_add_filter_none(m_archiveWriter.data());
         break;
@@ -318,9 +321,10 @@ bool ReadWriteLibarchivePlugin::initializeNewFileWriterFilters(const Compression
 {
     int ret;
     bool requiresExecutable = false;
+    const int gzipLevel = options.isCompressionLevelSet() ? options.compressionLevel() : Z_DEFAULT_COMPRESSION;
     if (filename().right(2).toUpper() == QLatin1String("GZ")) {
         qCDebug(ARK) << "Detected gzip compression for new file";
-        ret = archive_write_add_filter_gzip(m_archiveWriter.data());
+        ret = addGzipFilter(options, gzipLevel);
     } else if (filename().right(3).toUpper() == QLatin1String("BZ2")) {
         qCDebug(ARK) << "Detected bzip2 compression for new file";
         ret = archive_write_add_filter_bzip2(m_archiveWriter.data());
@@ -346,12 +350,17 @@ bool ReadWriteLibarchivePlugin::initializeNewFileWriterFilters(const Compression
         } else if (filename().right(3).toUpper() == QLatin1String("LZ4")) {
             qCDebug(ARK) << "Detected lz4 compression for new file";
             ret = archive_write_add_filter_lz4(m_archiveWriter.data());
+#ifdef ARCHIVE_FILTER_ZSTD
+    } else if (filename().right(3).toUpper() == QLatin1String("ZST")) {
+        qCDebug(ARK) << "Detected zstd compression for new file";
+        ret = archive_write_add_filter_zstd(m_archiveWriter.data());
+#endif
     } else if (filename().right(3).toUpper() == QLatin1String("TAR")) {
         qCDebug(ARK) << "Detected no compression for new file (pure tar)";
         ret = archive_write_add_filter_none(m_archiveWriter.data());
     } else {
         qCDebug(ARK) << "Falling back to gzip";
-        ret = archive_write_add_filter_gzip(m_archiveWriter.data());
+        ret = addGzipFilter(options, gzipLevel);
     }
 
     // Libarchive emits a warning for lrzip due to using external executable.
@@ -363,7 +372,8 @@ bool ReadWriteLibarchivePlugin::initializeNewFileWriterFilters(const Compression
     }
 
     // Set compression level if passed in CompressionOptions.
-    if (options.isCompressionLevelSet()) {
+    // The parallel gzip writer takes care of it by itself.
+    if (options.isCompressionLevelSet() && !m_gzipWriter) {
         qCDebug(ARK) << "Using compression level:" << options.compressionLevel();
         ret = archive_write_set_filter_option(m_archiveWriter.data(), nullptr, "compression-level", QString::number(options.compressionLevel()).toUtf8());
         if (ret != ARCHIVE_OK) {
@@ -373,11 +383,66 @@ bool ReadWriteLibarchivePlugin::initializeNewFileWriterFilters(const Compression
         }
     }
 
+#ifdef ARCHIVE_FILTER_ZSTD
+    // Long distance matching finds repetitions up to 128 MiB apart, which
+    // the default window size of the decoders still allows to decompress.
+    if (archive_filter_code(m_archiveWriter.data(), 0) == ARCHIVE_FILTER_ZSTD &&
+        options.compressionMethod() == QLatin1String("Zstandard Long")) {
+        qCDebug(ARK) << "Using zstd long distance matching";
+        ret = archive_write_set_filter_option(m_archiveWriter.data(), "zstd", "long", "27");
+        if (ret != ARCHIVE_OK) {
+            qCWarning(ARK) << "Failed to enable long distance matching:" << archive_error_string(m_archiveWriter.data());
+        }
+    }
+#endif
+
     return true;
 }
 
+int ReadWriteLibarchivePlugin::addGzipFilter(const CompressionOptions &options, int level)
+{
+    if (options.numberOfThreads() > 1) {
+        qCDebug(ARK) << "Compressing gzip with" << options.numberOfThreads() << "threads";
+        m_gzipWriter.reset(new ParallelGzipWriter(&m_tempFile, options.numberOfThreads(), level));
+        return archive_write_add_filter_none(m_archiveWriter.data());
+    }
+
+    return archive_write_add_filter_gzip(m_archiveWriter.data());
+}
+
+void ReadWriteLibarchivePlugin::setFilterThreads(const CompressionOptions &options)
+{
+    if (!options.isNumberOfThreadsSet()) {
+        return;
+    }
+
+    // The threads options of the xz and zstd filters are not available in older
+    // libarchive versions, in which case a single thread is used.
+    const char *module;
+    switch (archive_filter_code(m_archiveWriter.data(), 0)) {
+    case ARCHIVE_FILTER_XZ:
+        module = "xz";
+        break;
+#ifdef ARCHIVE_FILTER_ZSTD
+    case ARCHIVE_FILTER_ZSTD:
+        module = "zstd";
+        break;
+#endif
+    default:
+        return;
+    }
+
+    qCDebug(ARK) << "Using compression threads:" << options.numberOfThreads();
+    const int ret = archive_write_set_filter_option(m_archiveWriter.data(), module, "threads",
+                                                    QByteArray::number(options.numberOfThreads()).constData());
+    if (ret != ARCHIVE_OK) {
+        qCWarning(ARK) << "Failed to set the number of compression threads:" << archive_error_string(m_archiveWriter.data());
+    }
+}
+
 void ReadWriteLibarchivePlugin::finish(const bool isSuccessful)
 {
+    flushEntries();
     if (!isSuccessful || QThread::currentThread()->isInterruptionRequested()) {
         m_tempFile.cancelWriting();
     }
@@ -393,8 +458,9 @@ bool ReadWriteLibarchivePlugin::processOldEntries(uint &entriesCounter, Operatio
     entriesCounter = 0;
     uint iteratedEntries = 0;
 
-    // Create a map that contains old path as key and new path as value.
-    QMap<QString, QString> pathMap;
+    // Map the old paths to the new ones. Added files replace only the entries
+    // with the same path, other operations apply to whole directories.
+    PathMapping pathMap(mode == Add ? PathMapping::ExactPaths : PathMapping::Subtree);
     if (mode == Move || mode == Copy) {
         m_filesPaths.sort();
         QStringList resultList = entryPathsFromDestination(m_filesPaths, m_destination, m_entriesWithoutChildren);
@@ -403,15 +469,52 @@ bool ReadWriteLibarchivePlugin::processOldEntries(uint &entriesCounter, Operatio
         for (int i = 0; i < listSize; ++i) {
             pathMap.insert(m_filesPaths.at(i), resultList.at(i));
         }
+    } else {
+        foreach (const QString &path, m_filesPaths) {
+            pathMap.insert(path);
+        }
     }
 
+    // Consecutive entries which are kept as they are get copied in one go,
+    // from the position of the first header to the position of the next
+    // modified entry.
+    QFile oldArchive(filename());
+    const bool copyRawEntries = m_copyRawEntries && oldArchive.open(QIODevice::ReadOnly);
+    qint64 rawStart = -1;
+
     while (!QThread::currentThread()->isInterruptionRequested() && archive_read_next_header(m_archiveReader.data(), &entry) == ARCHIVE_OK) {
 
-        const QString file = QFile::decodeName(archive_entry_pathname(entry));
+        const char *pathname = archive_entry_pathname(entry);
+        const QByteArray path = QByteArray::fromRawData(pathname, pathname ? int(strlen(pathname)) : 0);
+        const bool isModified = pathMap.contains(path);
+        const qint64 headerPosition = archive_read_header_position(m_archiveReader.data());
+
+        if (copyRawEntries) {
+            if (!isModified) {
+                if (rawStart < 0) {
+                    rawStart = headerPosition;
+                }
+                if (mode == Add) {
+                    entriesCounter++;
+                } else {
+                    iteratedEntries++;
+                }
+                emit progress(float(newEntries + entriesCounter + iteratedEntries)/float(totalCount));
+                continue;
+            }
+
+            if (rawStart >= 0) {
+                if (!copyRawData(&oldArchive, rawStart, headerPosition)) {
+                    return false;
+                }
+                rawStart = -1;
+            }
+        }
 
-        if (mode == Move || mode == Copy) {
-            const QString newPathname = pathMap.value(file);
+        if (isModified && (mode == Move || mode == Copy)) {
+            const QByteArray newPathname = pathMap.newPath(path);
             if (!newPathname.isEmpty()) {
+                const QString file = QFile::decodeName(path);
                 if (mode == Copy) {
                     // Write the old entry.
                     if (!writeEntry(entry)) {
@@ -425,10 +528,11 @@ bool ReadWriteLibarchivePlugin::processOldEntries(uint &entriesCounter, Operatio
                 iteratedEntries--;
 
                 // Change entry path.
-                archive_entry_set_pathname(entry, newPathname.toUtf8());
+                archive_entry_set_pathname(entry, newPathname.constData());
                 emitEntryFromArchiveEntry(entry);
             }
-        } else if (m_filesPaths.contains(file)) {
+        } else if (isModified) {
+            const QString file = QFile::decodeName(path);
             archive_read_data_skip(m_archiveReader.data());
             switch (mode) {
             case Delete:
@@ -466,6 +570,41 @@ bool ReadWriteLibarchivePlugin::processOldEntries(uint &entriesCounter, Operatio
         emit progress(float(newEntries + entriesCounter + iteratedEntries)/float(totalCount));
     }
 
+    // After the last header, the header position is the end of the last entry.
+    if (rawStart >= 0 && !QThread::currentThread()->isInterruptionRequested()) {
+        return copyRawData(&oldArchive, rawStart, archive_read_header_position(m_archiveReader.data()));
+    }
+
+    return true;
+}
+
+bool ReadWriteLibarchivePlugin::copyRawData(QFile *source, qint64 from, qint64 to)
+{
+    // The padding of the entry last written by libarchive has to come first.
+    if (archive_write_finish_entry(m_archiveWriter.data()) != ARCHIVE_OK) {
+        qCCritical(ARK) << "Could not finish the last entry:" << archive_error_string(m_archiveWriter.data());
+        emit error(i18nc("@info", "Could not copy the entries of the archive, operation aborted."));
+        return false;
+    }
+
+    if (!source->seek(from)) {
+        qCCritical(ARK) << "Could not seek to" << from << "in" << source->fileName();
+        emit error(i18nc("@info", "Could not copy the entries of the archive, operation aborted."));
+        return false;
+    }
+
+    QByteArray buffer(static_cast<int>(qMin(rawCopyBufferSize, to - from)), Qt::Uninitialized);
+    while (from < to) {
+        const qint64 readBytes = source->read(buffer.data(), qMin<qint64>(buffer.size(), to - from));
+        if (readBytes <= 0 || m_tempFile.write(buffer.constData(), readBytes) != readBytes) {
+            qCCritical(ARK) << "Error while copying the entries of" << source->fileName() << ":"
+                            << source->errorString() << m_tempFile.errorString();
+            emit error(i18nc("@info", "Could not copy the entries of the archive, operation aborted."));
+            return false;
+        }
+        from += readBytes;
+    }
+
     return true;
 }
 
@@ -495,29 +634,26 @@ bool ReadWriteLibarchivePlugin::writeEntry(struct archive_entry *entry)
 
 // TODO: if we merge this with copyData(), we can pass more data
 //       such as an fd to archive_read_disk_entry_from_file()
-bool ReadWriteLibarchivePlugin::writeFile(const QString &relativeName, const QString &destination)
+bool ReadWriteLibarchivePlugin::writeFile(const FileManifest::File &file, const QString &destination)
 {
     int header_response;
-    const QString absoluteFilename = QFileInfo(relativeName).absoluteFilePath();
-    const QString destinationFilename = destination + relativeName;
+    const QString absoluteFilename = QFileInfo(file.path).absoluteFilePath();
+    const QString destinationFilename = destination + file.path;
 
     // #253059: Even if we use archive_read_disk_entry_from_file,
     //          libarchive may have been compiled without HAVE_LSTAT,
     //          or something may have caused it to follow symlinks, in
     //          which case stat() will be called. To avoid this, we
-    //          call lstat() ourselves.
-    struct stat st;
-    lstat(QFile::encodeName(absoluteFilename).constData(), &st);
-
+    //          pass the lstat() result of the manifest ourselves.
     struct archive_entry *entry = archive_entry_new();
     archive_entry_set_pathname(entry, QFile::encodeName(destinationFilename).constData());
     archive_entry_copy_sourcepath(entry, QFile::encodeName(absoluteFilename).constData());
-    archive_read_disk_entry_from_file(m_archiveReadDisk.data(), entry, -1, &st);
+    archive_read_disk_entry_from_file(m_archiveReadDisk.data(), entry, -1, &file.status);
 
     if ((header_response = archive_write_header(m_archiveWriter.data(), entry)) == ARCHIVE_OK) {
         // If the whole archive is extracted and the total filesize is
         // available, we use partial progress.
-        copyData(absoluteFilename, m_archiveWriter.data(), false);
+        copyData(absoluteFilename, m_archiveWriter.data());
     } else {
         qCCritical(ARK) << "Writing header failed with error code " << header_response;
         qCCritical(ARK) << "Error while writing..." << archive_error_string(m_archiveWriter.data()) << "(error no =" << archive_errno(m_archiveWriter.data()) << ')';
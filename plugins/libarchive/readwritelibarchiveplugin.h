@@ -29,6 +29,7 @@
 #define READWRITELIBARCHIVEPLUGIN_H
 
 #include "libarchiveplugin.h"
+#include "parallelgzipwriter.h"
 
 #include <QDir>
 #include <QStringList>
@@ -51,7 +52,7 @@ public:
 
 protected:
     bool initializeWriter(const bool creatingNewFile = false, const CompressionOptions &options = CompressionOptions());
-    bool initializeWriterFilters();
+    bool initializeWriterFilters(const CompressionOptions &options = CompressionOptions());
     bool initializeNewFileWriterFilters(const CompressionOptions &options);
     void finish(const bool isSuccessful);
 
@@ -78,11 +79,37 @@ private:
      *
      * @return bool indicating whether the operation was successful.
      */
-    bool writeFile(const QString &relativeName, const QString &destination);
+    bool writeFile(const FileManifest::File &file, const QString &destination);
+
+    /**
+     * Copies the bytes from @p from to @p to of the old archive @p source
+     * to the new archive, without decoding them.
+     *
+     * @return bool indicating whether the operation was successful.
+     */
+    bool copyRawData(QFile *source, qint64 from, qint64 to);
+
+    /**
+     * Adds the gzip filter to the writer. When several threads are requested,
+     * the tar is compressed by a ParallelGzipWriter instead of libarchive.
+     *
+     * @return The result of adding the filter.
+     */
+    int addGzipFilter(const CompressionOptions &options, int level);
+
+    /**
+     * Sets the number of threads of the compression filter, if it supports it.
+     */
+    void setFilterThreads(const CompressionOptions &options);
 
     QSaveFile m_tempFile;
+    // Must be destroyed after m_archiveWriter, which writes to it when closed.
+    QScopedPointer<ParallelGzipWriter> m_gzipWriter;
     ArchiveWrite m_archiveWriter;
 
+    // Whether the kept entries of an uncompressed tar are copied as they are.
+    bool m_copyRawEntries = false;
+
     // New added files by addFiles methods. It's assigned to m_filesPaths
     // and then is used by processOldEntries method (in Add mode) for skipping already written entries.
     QStringList m_writtenFiles;
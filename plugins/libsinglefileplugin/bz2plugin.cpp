@@ -24,6 +24,7 @@
  */
 
 #include "bz2plugin.h"
+#include "parallelbzip2decompressor.h"
 
 #include <QString>
 
@@ -42,4 +43,9 @@ LibBzip2Interface::~LibBzip2Interface()
 {
 }
 
+ParallelDecompressor *LibBzip2Interface::createParallelDecompressor(int threadCount) const
+{
+    return new ParallelBzip2Decompressor(threadCount);
+}
+
 #include "bz2plugin.moc"
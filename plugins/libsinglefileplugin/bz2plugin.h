@@ -35,6 +35,9 @@ class KERFUFFLE_EXPORT LibBzip2Interface : public LibSingleFileInterface
 public:
     LibBzip2Interface(QObject *parent, const QVariantList & args);
     ~LibBzip2Interface() override;
+
+protected:
+    ParallelDecompressor *createParallelDecompressor(int threadCount) const override;
 };
 
 #endif // BZ2PLUGIN_H
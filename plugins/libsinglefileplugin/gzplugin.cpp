@@ -25,6 +25,7 @@
 
 #include "gzplugin.h"
 #include "kerfuffle_export.h"
+#include "parallelgzipdecompressor.h"
 
 #include <QString>
 
@@ -43,4 +44,9 @@ LibGzipInterface::~LibGzipInterface()
 {
 }
 
+ParallelDecompressor *LibGzipInterface::createParallelDecompressor(int threadCount) const
+{
+    return new ParallelGzipDecompressor(threadCount);
+}
+
 #include "gzplugin.moc"
@@ -35,6 +35,9 @@ class KERFUFFLE_EXPORT LibGzipInterface : public LibSingleFileInterface
 public:
     LibGzipInterface(QObject *parent, const QVariantList & args);
     ~LibGzipInterface() override;
+
+protected:
+    ParallelDecompressor *createParallelDecompressor(int threadCount) const override;
 };
 
 #endif // GZPLUGIN_H
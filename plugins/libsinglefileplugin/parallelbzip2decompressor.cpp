@@ -0,0 +1,274 @@
+/*
+ * Copyright (c) 2026 The Ark developers <kde-utils-devel@kde.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES ( INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION ) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * ( INCLUDING NEGLIGENCE OR OTHERWISE ) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "parallelbzip2decompressor.h"
+#include "ark_debug.h"
+
+#include <QIODevice>
+
+#include <bzlib.h>
+
+#include <cstring>
+
+static const quint64 blockMagic = Q_UINT64_C(0x314159265359);
+static const quint64 endOfStreamMagic = Q_UINT64_C(0x177245385090);
+static const quint64 magicMask = Q_UINT64_C(0xffffffffffff);
+
+// How much of the input is read at once.
+static const int readSize = 1024 * 1024;
+
+// Compressed blocks are smaller than 1 MB, a magic not found after that
+// means that the data is not a bzip2 stream.
+static const int maxBlockSize = 4 * 1024 * 1024;
+
+static quint64 readBigEndian64(const uchar *data)
+{
+    quint64 value = 0;
+    for (int i = 0; i < 8; i++) {
+        value = (value << 8) | data[i];
+    }
+    return value;
+}
+
+/**
+ * For each value of the 16 bits following the first byte of a magic,
+ * the offsets in that byte at which a block or end of stream magic can start.
+ */
+static const quint8 *magicOffsets()
+{
+    static quint8 offsets[65536];
+    static const bool initialized = [] {
+        for (int offset = 0; offset < 8; offset++) {
+            offsets[(blockMagic >> (24 + offset)) & 0xffff] |= 1 << offset;
+            offsets[(endOfStreamMagic >> (24 + offset)) & 0xffff] |= 1 << offset;
+        }
+        return true;
+    }();
+    Q_UNUSED(initialized)
+
+    return offsets;
+}
+
+ParallelBzip2Decompressor::ParallelBzip2Decompressor(int threadCount)
+    : ParallelDecompressor(threadCount)
+    , m_position(0)
+    , m_searchingStream(false)
+    , m_combinedCrc(0)
+{
+}
+
+bool ParallelBzip2Decompressor::open(QIODevice *input)
+{
+    if (!fillBuffer(input) || m_buffer.size() < 4 || !m_buffer.startsWith("BZh")
+            || m_buffer.at(3) < '1' || m_buffer.at(3) > '9') {
+        return false;
+    }
+
+    // The first block, or the end of an empty stream, follows the header.
+    m_position = 32;
+    return true;
+}
+
+ParallelDecompressor::ChunkStatus ParallelBzip2Decompressor::readChunk(QIODevice *input, QByteArray *chunk)
+{
+    forever {
+        // Drop the data already split, but not for every block.
+        const int splitSize = static_cast<int>(m_position / 8);
+        if (splitSize >= readSize) {
+            m_buffer.remove(0, splitSize);
+            m_position -= 8 * splitSize;
+        }
+
+        bool endOfStream;
+        const qint64 magic = findMagic(input, m_position, &endOfStream);
+        if (magic < 0) {
+            // Only padding can follow the end of the last stream.
+            return m_searchingStream && input->atEnd() ? NoMoreChunks : InvalidChunk;
+        }
+        if (!m_searchingStream && magic != m_position) {
+            return InvalidChunk;
+        }
+        if (magic + 80 > 8 * static_cast<qint64>(m_buffer.size())) {
+            return InvalidChunk;
+        }
+
+        if (endOfStream) {
+            if (readBits32(magic + 48) != m_combinedCrc) {
+                qCWarning(ARK) << "The CRC of the bzip2 stream does not match the CRCs of its blocks";
+                return InvalidChunk;
+            }
+            m_combinedCrc = 0;
+            m_position = magic + 80;
+            m_searchingStream = true;
+            continue;
+        }
+
+        const qint64 end = findMagic(input, magic + 48, &endOfStream);
+        if (end < 0) {
+            return InvalidChunk;
+        }
+
+        const quint32 blockCrc = readBits32(magic + 48);
+        m_combinedCrc = ((m_combinedCrc << 1) | (m_combinedCrc >> 31)) ^ blockCrc;
+
+        *chunk = singleBlockStream(magic, end);
+        m_position = end;
+        m_searchingStream = false;
+        return NextChunk;
+    }
+}
+
+bool ParallelBzip2Decompressor::decompressChunk(int index, const QByteArray &chunk, QByteArray *data) const
+{
+    Q_UNUSED(index)
+
+    bz_stream stream;
+    stream.bzalloc = nullptr;
+    stream.bzfree = nullptr;
+    stream.opaque = nullptr;
+    if (BZ2_bzDecompressInit(&stream, 0, 0) != BZ_OK) {
+        return false;
+    }
+
+    stream.next_in = const_cast<char*>(chunk.constData());
+    stream.avail_in = static_cast<unsigned int>(chunk.size());
+
+    data->resize(4 * chunk.size());
+    int decompressedSize = 0;
+    int result;
+    forever {
+        stream.next_out = data->data() + decompressedSize;
+        stream.avail_out = static_cast<unsigned int>(data->size() - decompressedSize);
+        result = BZ2_bzDecompress(&stream);
+        decompressedSize = data->size() - static_cast<int>(stream.avail_out);
+
+        if (result != BZ_OK || (stream.avail_out > 0 && stream.avail_in == 0)) {
+            break;
+        }
+        if (stream.avail_out == 0) {
+            data->resize(2 * data->size());
+        }
+    }
+    BZ2_bzDecompressEnd(&stream);
+
+    data->resize(decompressedSize);
+    return result == BZ_STREAM_END && stream.avail_in == 0;
+}
+
+bool ParallelBzip2Decompressor::fillBuffer(QIODevice *input)
+{
+    const int bufferSize = m_buffer.size();
+    m_buffer.resize(bufferSize + readSize);
+    const qint64 bytesRead = input->read(m_buffer.data() + bufferSize, readSize);
+    m_buffer.resize(bufferSize + static_cast<int>(qMax<qint64>(0, bytesRead)));
+    return bytesRead > 0;
+}
+
+qint64 ParallelBzip2Decompressor::findMagic(QIODevice *input, qint64 fromBit, bool *endOfStream)
+{
+    const quint8 *offsets = magicOffsets();
+    qint64 byte = fromBit / 8;
+
+    forever {
+        // A magic is compared with the 8 bytes starting from the byte it starts in.
+        const uchar *data = reinterpret_cast<const uchar*>(m_buffer.constData());
+        const qint64 lastByte = m_buffer.size() - 8;
+        for (; byte <= lastByte; byte++) {
+            const quint8 byteOffsets = offsets[(data[byte + 1] << 8) | data[byte + 2]];
+            if (byteOffsets == 0) {
+                continue;
+            }
+
+            const quint64 bits = readBigEndian64(data + byte);
+            for (int offset = 0; offset < 8; offset++) {
+                const qint64 position = 8 * byte + offset;
+                if (!(byteOffsets & (1 << offset)) || position < fromBit) {
+                    continue;
+                }
+
+                const quint64 candidate = (bits >> (16 - offset)) & magicMask;
+                if (candidate == blockMagic || candidate == endOfStreamMagic) {
+                    *endOfStream = candidate == endOfStreamMagic;
+                    // The CRC following the magic has to be in the buffer too.
+                    while (position + 80 > 8 * static_cast<qint64>(m_buffer.size()) && fillBuffer(input)) {
+                    }
+                    return position;
+                }
+            }
+        }
+
+        if (byte - fromBit / 8 > maxBlockSize || !fillBuffer(input)) {
+            return -1;
+        }
+    }
+}
+
+quint32 ParallelBzip2Decompressor::readBits32(qint64 bit) const
+{
+    // The 32 bits span 5 bytes at most, the missing ones after the end of the buffer are zeros.
+    quint64 bits = 0;
+    for (qint64 byte = bit / 8; byte < bit / 8 + 5; byte++) {
+        bits = (bits << 8) | (byte < m_buffer.size() ? static_cast<uchar>(m_buffer.at(static_cast<int>(byte))) : 0);
+    }
+    return static_cast<quint32>(bits >> (8 - bit % 8));
+}
+
+QByteArray ParallelBzip2Decompressor::singleBlockStream(qint64 startBit, qint64 endBit) const
+{
+    // The header of the stream is followed by the block, shifted to start on a byte,
+    // then by the end of stream magic with the CRC of the only block as stream CRC.
+    // The highest block size is declared, it is only the upper bound of the decoder.
+    const qint64 bitCount = endBit - startBit;
+    const int byteCount = static_cast<int>((bitCount + 7) / 8);
+    QByteArray stream("BZh9");
+    stream.resize(4 + byteCount + 11);
+
+    uchar *out = reinterpret_cast<uchar*>(stream.data()) + 4;
+    const uchar *in = reinterpret_cast<const uchar*>(m_buffer.constData()) + startBit / 8;
+    const int shift = startBit % 8;
+    for (int i = 0; i < byteCount; i++) {
+        // The magic following the block is in the buffer, in[i + 1] can always be read.
+        out[i] = static_cast<uchar>((in[i] << shift) | (shift > 0 ? in[i + 1] >> (8 - shift) : 0));
+    }
+    if (bitCount % 8 > 0) {
+        out[byteCount - 1] &= static_cast<uchar>(0xff << (8 - bitCount % 8));
+    }
+    memset(out + byteCount, 0, 11);
+
+    const quint64 trailer[2] = {endOfStreamMagic, readBits32(startBit + 48)};
+    const int trailerBits[2] = {48, 32};
+    qint64 position = bitCount;
+    for (int i = 0; i < 2; i++) {
+        for (int bit = trailerBits[i] - 1; bit >= 0; bit--) {
+            if ((trailer[i] >> bit) & 1) {
+                out[position / 8] |= static_cast<uchar>(0x80 >> (position % 8));
+            }
+            position++;
+        }
+    }
+
+    stream.resize(4 + static_cast<int>((position + 7) / 8));
+    return stream;
+}
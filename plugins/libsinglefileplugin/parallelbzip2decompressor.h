@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2026 The Ark developers <kde-utils-devel@kde.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES ( INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION ) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * ( INCLUDING NEGLIGENCE OR OTHERWISE ) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PARALLELBZIP2DECOMPRESSOR_H
+#define PARALLELBZIP2DECOMPRESSOR_H
+
+#include "paralleldecompressor.h"
+
+/**
+ * Decompresses the blocks of bzip2 streams from several threads.
+ *
+ * The blocks of a bzip2 stream are not aligned on bytes, they are found by
+ * their 48 bits magic number. Each block is copied into a stream of its own,
+ * which libbzip2 decompresses while checking the CRC of the block. The CRCs
+ * of the original streams are checked against the CRCs of their blocks.
+ */
+class ParallelBzip2Decompressor : public ParallelDecompressor
+{
+public:
+    explicit ParallelBzip2Decompressor(int threadCount);
+
+protected:
+    bool open(QIODevice *input) override;
+    ChunkStatus readChunk(QIODevice *input, QByteArray *chunk) override;
+    bool decompressChunk(int index, const QByteArray &chunk, QByteArray *data) const override;
+
+private:
+    /**
+     * Reads more of @p input into the buffer.
+     *
+     * @return False if there is nothing left to read.
+     */
+    bool fillBuffer(QIODevice *input);
+
+    /**
+     * Finds the first block or end of stream magic from @p fromBit of the buffer,
+     * reading more of @p input if needed.
+     *
+     * @return The position of the magic in bits, or -1 if none could be found.
+     */
+    qint64 findMagic(QIODevice *input, qint64 fromBit, bool *endOfStream);
+
+    quint32 readBits32(qint64 bit) const;
+
+    /**
+     * @return A bzip2 stream with the block between the bits @p startBit and @p endBit of the buffer.
+     */
+    QByteArray singleBlockStream(qint64 startBit, qint64 endBit) const;
+
+    QByteArray m_buffer;
+    // The position in bits of the next block in the buffer, or where to look for the next stream.
+    qint64 m_position;
+    bool m_searchingStream;
+    quint32 m_combinedCrc;
+};
+
+#endif // PARALLELBZIP2DECOMPRESSOR_H
@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2026 The Ark developers <kde-utils-devel@kde.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES ( INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION ) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * ( INCLUDING NEGLIGENCE OR OTHERWISE ) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "paralleldecompressor.h"
+#include "ark_debug.h"
+
+#include <QIODevice>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QThread>
+
+class ParallelDecompressor::DecompressTask : public QRunnable
+{
+public:
+    DecompressTask(ParallelDecompressor *decompressor, int index, const QByteArray &chunk)
+        : m_decompressor(decompressor)
+        , m_index(index)
+        , m_chunk(chunk)
+    {
+    }
+
+    void run() override
+    {
+        m_decompressor->runChunk(m_index, m_chunk);
+    }
+
+private:
+    ParallelDecompressor *m_decompressor;
+    int m_index;
+    QByteArray m_chunk;
+};
+
+ParallelDecompressor::ParallelDecompressor(int threadCount)
+    : m_queuedChunks(0)
+    , m_nextWrittenChunk(0)
+    , m_invalidData(false)
+    , m_writeFailed(false)
+{
+    setThreadCount(threadCount);
+}
+
+ParallelDecompressor::~ParallelDecompressor()
+{
+    m_threadPool.waitForDone();
+}
+
+ParallelDecompressor::Result ParallelDecompressor::decompress(QIODevice *input, QIODevice *output)
+{
+    if (!open(input)) {
+        return InvalidData;
+    }
+
+    const qint64 inputSize = input->size();
+    int lastProgress = -1;
+    Result result = Decompressed;
+
+    forever {
+        if (QThread::currentThread()->isInterruptionRequested()) {
+            result = Cancelled;
+            break;
+        }
+
+        QByteArray chunk;
+        const ChunkStatus status = readChunk(input, &chunk);
+        if (status == NoMoreChunks) {
+            break;
+        }
+        if (status == InvalidChunk) {
+            result = InvalidData;
+            break;
+        }
+
+        if (!writeChunks(output, false)) {
+            break;
+        }
+        queueChunk(chunk);
+
+        // Only emit when the permille changes, not for every chunk.
+        if (inputSize > 0) {
+            const int readProgress = static_cast<int>(1000 * input->pos() / inputSize);
+            if (readProgress != lastProgress) {
+                lastProgress = readProgress;
+                emit progress(readProgress / 1000.0);
+            }
+        }
+    }
+
+    if (result == Decompressed) {
+        writeChunks(output, true);
+    }
+    m_threadPool.waitForDone();
+
+    if (result != Decompressed) {
+        return result;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    if (m_writeFailed) {
+        return WriteError;
+    }
+    return m_invalidData ? InvalidData : Decompressed;
+}
+
+void ParallelDecompressor::setThreadCount(int threadCount)
+{
+    m_maxQueuedChunks = 2 * qMax(1, threadCount);
+    m_threadPool.setMaxThreadCount(qMax(1, threadCount));
+}
+
+void ParallelDecompressor::queueChunk(const QByteArray &chunk)
+{
+    int index;
+    {
+        QMutexLocker locker(&m_mutex);
+        index = m_nextWrittenChunk + m_queuedChunks;
+        m_queuedChunks++;
+    }
+
+    m_threadPool.start(new DecompressTask(this, index, chunk));
+}
+
+bool ParallelDecompressor::writeChunks(QIODevice *output, bool waitForAll)
+{
+    forever {
+        QByteArray data;
+        {
+            QMutexLocker locker(&m_mutex);
+            // Without waiting for all the chunks, wait only until there is room for a new one.
+            const int maxQueuedChunks = waitForAll ? 1 : m_maxQueuedChunks;
+            while (m_queuedChunks >= maxQueuedChunks && !m_chunks.contains(m_nextWrittenChunk) && !m_invalidData && !m_writeFailed) {
+                m_chunkDecompressed.wait(&m_mutex);
+            }
+
+            if (m_invalidData || m_writeFailed) {
+                return false;
+            }
+            if (!m_chunks.contains(m_nextWrittenChunk)) {
+                return true;
+            }
+
+            data = m_chunks.take(m_nextWrittenChunk);
+            m_nextWrittenChunk++;
+            m_queuedChunks--;
+        }
+
+        if (output->write(data) != data.size()) {
+            qCCritical(ARK) << "Could not write the decompressed data:" << output->errorString();
+            QMutexLocker locker(&m_mutex);
+            m_writeFailed = true;
+            return false;
+        }
+    }
+}
+
+void ParallelDecompressor::runChunk(int index, const QByteArray &chunk)
+{
+    {
+        // The chunks after an invalid one are not needed anymore.
+        QMutexLocker locker(&m_mutex);
+        if (m_invalidData || m_writeFailed) {
+            return;
+        }
+    }
+
+    QByteArray data;
+    const bool decompressed = decompressChunk(index, chunk, &data);
+
+    QMutexLocker locker(&m_mutex);
+    if (decompressed) {
+        m_chunks.insert(index, data);
+    } else {
+        qCWarning(ARK) << "Could not decompress chunk" << index;
+        m_invalidData = true;
+    }
+    m_chunkDecompressed.wakeAll();
+}
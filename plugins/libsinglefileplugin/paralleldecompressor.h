@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2026 The Ark developers <kde-utils-devel@kde.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES ( INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION ) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * ( INCLUDING NEGLIGENCE OR OTHERWISE ) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PARALLELDECOMPRESSOR_H
+#define PARALLELDECOMPRESSOR_H
+
+#include <QByteArray>
+#include <QMap>
+#include <QMutex>
+#include <QObject>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+class QIODevice;
+
+/**
+ * Decompresses a file from a pool of threads.
+ *
+ * Subclasses split the compressed data in chunks which can be decompressed
+ * independently, like the blocks of a bzip2 or xz stream. The chunks are
+ * read in order, decompressed by the threads and written to the output in
+ * order again.
+ *
+ * The number of chunks being decompressed is bounded, so that the memory
+ * used does not depend on the size of the file.
+ */
+class ParallelDecompressor : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Result {
+        Decompressed,
+        InvalidData,    /**< The data could not be split or decompressed, nothing reliable has been written. */
+        WriteError,
+        Cancelled
+    };
+
+    explicit ParallelDecompressor(int threadCount);
+
+    /**
+     * Waits for the queued chunks, without writing them.
+     */
+    ~ParallelDecompressor() override;
+
+    /**
+     * Decompresses the whole @p input to @p output, until the end of the input
+     * or until the interruption of the current thread is requested.
+     */
+    Result decompress(QIODevice *input, QIODevice *output);
+
+signals:
+    /**
+     * The part of the input read so far, between 0 and 1.
+     */
+    void progress(double progress);
+
+protected:
+    enum ChunkStatus {
+        NextChunk,
+        NoMoreChunks,
+        InvalidChunk
+    };
+
+    /**
+     * Reads the headers, or whatever else is needed to split @p input.
+     *
+     * @return False if the data of @p input cannot be decompressed in parallel.
+     */
+    virtual bool open(QIODevice *input) = 0;
+
+    /**
+     * Reads the next chunk of @p input into @p chunk.
+     */
+    virtual ChunkStatus readChunk(QIODevice *input, QByteArray *chunk) = 0;
+
+    /**
+     * Decompresses @p chunk, the chunk number @p index, into @p data.
+     * Called from several threads at the same time.
+     *
+     * @return False if @p chunk is not valid.
+     */
+    virtual bool decompressChunk(int index, const QByteArray &chunk, QByteArray *data) const = 0;
+
+    /**
+     * Changes the number of threads, and thus of queued chunks. Only to be
+     * called from open(), before any chunk is queued.
+     */
+    void setThreadCount(int threadCount);
+
+private:
+    class DecompressTask;
+
+    void runChunk(int index, const QByteArray &chunk);
+    void queueChunk(const QByteArray &chunk);
+
+    /**
+     * Writes the chunks decompressed so far, in order. Waits for all the queued
+     * chunks if @p waitForAll is true, else only until a chunk can be queued.
+     */
+    bool writeChunks(QIODevice *output, bool waitForAll);
+
+    QThreadPool m_threadPool;
+    QMutex m_mutex;
+    QWaitCondition m_chunkDecompressed;
+
+    int m_maxQueuedChunks;
+
+    int m_queuedChunks;
+    int m_nextWrittenChunk;
+    QMap<int, QByteArray> m_chunks;
+    bool m_invalidData;
+    bool m_writeFailed;
+};
+
+#endif // PARALLELDECOMPRESSOR_H
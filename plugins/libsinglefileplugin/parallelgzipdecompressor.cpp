@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2026 The Ark developers <kde-utils-devel@kde.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES ( INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION ) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * ( INCLUDING NEGLIGENCE OR OTHERWISE ) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "parallelgzipdecompressor.h"
+#include "ark_debug.h"
+
+#include <QIODevice>
+
+#include <zlib.h>
+
+#include <cstring>
+
+// The magic and compression method which start every member.
+static const QByteArray memberMagic("\x1f\x8b\x08");
+static const int memberHeaderSize = 10;
+
+// How much of the input is read at once.
+static const int readSize = 1024 * 1024;
+
+// Chunks hold at least this much compressed data, unless it is the last one.
+static const int minChunkSize = 1024 * 1024;
+
+// Without a member header found in this much data, the file is not split.
+static const int maxChunkSize = 16 * 1024 * 1024;
+
+// The decompressed data of a chunk is kept in memory until it is written.
+// Chunks which decompress to more are left to the single thread decompressor.
+static const int maxChunkDataSize = 64 * 1024 * 1024;
+
+// The decompressed chunks waiting to be written are bounded by this amount.
+static const qint64 maxQueuedSize = Q_INT64_C(1024) * 1024 * 1024;
+
+ParallelGzipDecompressor::ParallelGzipDecompressor(int threadCount)
+    : ParallelDecompressor(threadCount)
+    , m_threadCount(threadCount)
+{
+}
+
+bool ParallelGzipDecompressor::open(QIODevice *input)
+{
+    m_buffer.clear();
+    if (!fillBuffer(input) || m_buffer.size() < memberHeaderSize || !isMemberHeader(0)) {
+        return false;
+    }
+
+    // Twice as many chunks as threads are in memory at the same time,
+    // and the size of their data is only known once they are decompressed.
+    const int threadCount = static_cast<int>(qBound<qint64>(1, maxQueuedSize / (2 * (maxChunkDataSize + maxChunkSize)), m_threadCount));
+    if (threadCount < m_threadCount) {
+        qCDebug(ARK) << "Decompressing the gzip members from" << threadCount << "threads instead of" << m_threadCount;
+    }
+    setThreadCount(threadCount);
+
+    return true;
+}
+
+ParallelDecompressor::ChunkStatus ParallelGzipDecompressor::readChunk(QIODevice *input, QByteArray *chunk)
+{
+    int searchFrom = minChunkSize;
+    forever {
+        int member = m_buffer.indexOf(memberMagic, searchFrom);
+        while (member >= 0 && member + memberHeaderSize <= m_buffer.size() && !isMemberHeader(member)) {
+            member = m_buffer.indexOf(memberMagic, member + 1);
+        }
+
+        if (member >= 0 && member + memberHeaderSize <= m_buffer.size()) {
+            *chunk = m_buffer.left(member);
+            m_buffer.remove(0, member);
+            return NextChunk;
+        }
+
+        // Search again from a header which is not complete, or from the bytes which can start one.
+        searchFrom = member >= 0 ? member : qMax(searchFrom, m_buffer.size() - memberMagic.size() + 1);
+
+        if (!fillBuffer(input)) {
+            if (m_buffer.isEmpty()) {
+                return NoMoreChunks;
+            }
+            *chunk = m_buffer;
+            m_buffer.clear();
+            return NextChunk;
+        }
+
+        if (m_buffer.size() > maxChunkSize) {
+            qCDebug(ARK) << "No gzip member found, the file is not decompressed in parallel";
+            return InvalidChunk;
+        }
+    }
+}
+
+bool ParallelGzipDecompressor::decompressChunk(int index, const QByteArray &chunk, QByteArray *data) const
+{
+    Q_UNUSED(index)
+
+    z_stream stream;
+    stream.zalloc = Z_NULL;
+    stream.zfree = Z_NULL;
+    stream.opaque = Z_NULL;
+    stream.next_in = Z_NULL;
+    stream.avail_in = 0;
+
+    // A window size of 15 + 16 makes zlib read a gzip header and trailer.
+    if (inflateInit2(&stream, 15 + 16) != Z_OK) {
+        return false;
+    }
+
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(chunk.constData()));
+    stream.avail_in = static_cast<uInt>(chunk.size());
+
+    data->resize(qMin(4 * chunk.size(), maxChunkDataSize));
+    int decompressedSize = 0;
+    int result;
+    forever {
+        stream.next_out = reinterpret_cast<Bytef*>(data->data() + decompressedSize);
+        stream.avail_out = static_cast<uInt>(data->size() - decompressedSize);
+        result = inflate(&stream, Z_NO_FLUSH);
+        decompressedSize = data->size() - static_cast<int>(stream.avail_out);
+
+        if (result == Z_STREAM_END) {
+            // The members of the chunk have to end with it.
+            if (stream.avail_in == 0) {
+                break;
+            }
+            inflateReset(&stream);
+        } else if (result != Z_OK && result != Z_BUF_ERROR) {
+            break;
+        } else if (stream.avail_out == 0 && data->size() < maxChunkDataSize) {
+            data->resize(qMin(2 * data->size(), maxChunkDataSize));
+        } else {
+            // Either the chunk ends in the middle of a member, or its data is too large.
+            break;
+        }
+    }
+    inflateEnd(&stream);
+
+    data->resize(decompressedSize);
+    return result == Z_STREAM_END && stream.avail_in == 0;
+}
+
+bool ParallelGzipDecompressor::fillBuffer(QIODevice *input)
+{
+    const int bufferSize = m_buffer.size();
+    m_buffer.resize(bufferSize + readSize);
+    const qint64 bytesRead = input->read(m_buffer.data() + bufferSize, readSize);
+    m_buffer.resize(bufferSize + static_cast<int>(qMax<qint64>(0, bytesRead)));
+    return bytesRead > 0;
+}
+
+bool ParallelGzipDecompressor::isMemberHeader(int position) const
+{
+    const uchar *header = reinterpret_cast<const uchar*>(m_buffer.constData()) + position;
+
+    // The magic has to be followed by flags without the reserved bits,
+    // then by the modification time, the extra flags and the OS.
+    const uchar flags = header[3];
+    const uchar extraFlags = header[8];
+    const uchar os = header[9];
+    return memcmp(header, memberMagic.constData(), memberMagic.size()) == 0
+            && (flags & 0xe0) == 0
+            && (extraFlags == 0 || extraFlags == 2 || extraFlags == 4)
+            && (os <= 13 || os == 255);
+}
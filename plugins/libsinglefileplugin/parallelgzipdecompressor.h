@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2026 The Ark developers <kde-utils-devel@kde.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES ( INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION ) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * ( INCLUDING NEGLIGENCE OR OTHERWISE ) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PARALLELGZIPDECOMPRESSOR_H
+#define PARALLELGZIPDECOMPRESSOR_H
+
+#include "paralleldecompressor.h"
+
+/**
+ * Decompresses the members of a multi-member gzip file from several threads.
+ *
+ * Files written by parallel compressors like bgzip, or by Ark itself, are
+ * made of many gzip members. The data is split at what looks like the
+ * header of a member: a wrong guess makes the decompression of the chunk
+ * fail, as the members of a chunk have to end exactly with it. zlib verifies
+ * the CRC and size of every member.
+ *
+ * The deflate stream of a single member cannot be split, those files are
+ * not decompressed in parallel. The number of threads is limited so that
+ * the queued chunks fit in 1 GiB, whatever they decompress to.
+ */
+class ParallelGzipDecompressor : public ParallelDecompressor
+{
+public:
+    explicit ParallelGzipDecompressor(int threadCount);
+
+protected:
+    bool open(QIODevice *input) override;
+    ChunkStatus readChunk(QIODevice *input, QByteArray *chunk) override;
+    bool decompressChunk(int index, const QByteArray &chunk, QByteArray *data) const override;
+
+private:
+    /**
+     * Reads more of @p input into the buffer.
+     *
+     * @return False if there is nothing left to read.
+     */
+    bool fillBuffer(QIODevice *input);
+
+    /**
+     * @return Whether the buffer has a plausible member header at @p position.
+     */
+    bool isMemberHeader(int position) const;
+
+    const int m_threadCount;
+
+    // The data of the next chunks.
+    QByteArray m_buffer;
+};
+
+#endif // PARALLELGZIPDECOMPRESSOR_H
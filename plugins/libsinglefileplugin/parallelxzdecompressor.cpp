@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2026 The Ark developers <kde-utils-devel@kde.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES ( INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION ) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * ( INCLUDING NEGLIGENCE OR OTHERWISE ) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "parallelxzdecompressor.h"
+#include "ark_debug.h"
+
+#include <QIODevice>
+
+#include <lzma.h>
+
+#include <climits>
+#include <cstdlib>
+
+// The decompressed blocks waiting to be written are kept in memory,
+// their total size is bounded by this amount.
+static const qint64 maxQueuedSize = Q_INT64_C(1024) * 1024 * 1024;
+
+static bool readAt(QIODevice *input, qint64 position, qint64 size, QByteArray *data)
+{
+    if (position < 0 || !input->seek(position)) {
+        return false;
+    }
+    *data = input->read(size);
+    return data->size() == size;
+}
+
+ParallelXzDecompressor::ParallelXzDecompressor(int threadCount)
+    : ParallelDecompressor(threadCount)
+    , m_threadCount(threadCount)
+    , m_nextBlock(0)
+{
+}
+
+bool ParallelXzDecompressor::open(QIODevice *input)
+{
+    m_blocks.clear();
+    m_nextBlock = 0;
+
+    // The streams are read from the last one, each one ends with its index.
+    qint64 position = input->size();
+    QByteArray padding;
+    while (position > 0) {
+        // Streams can be followed by padding, in groups of 4 null bytes.
+        while (readAt(input, position - 4, 4, &padding) && padding == QByteArray(4, '\0')) {
+            position -= 4;
+        }
+
+        if (!readStreamIndex(input, &position)) {
+            qCDebug(ARK) << "Could not read the index of the xz stream ending at" << position;
+            return false;
+        }
+    }
+
+    // A single block is decompressed as fast from one thread.
+    if (m_blocks.size() < 2) {
+        return false;
+    }
+
+    // Twice as many blocks as threads are in memory at the same time, so
+    // large blocks are decompressed from fewer threads. Blocks which don't fit
+    // in a QByteArray or twice in the memory limit are left to the single
+    // threaded decompressor.
+    qint64 largestBlockSize = 1;
+    foreach (const Block &block, m_blocks) {
+        if (block.uncompressedSize > static_cast<quint64>(maxQueuedSize / 2)
+                || block.uncompressedSize > static_cast<quint64>(INT_MAX)
+                || block.totalSize > INT_MAX) {
+            qCDebug(ARK) << "The xz block of" << block.uncompressedSize << "bytes is too large to be decompressed in parallel";
+            return false;
+        }
+        largestBlockSize = qMax(largestBlockSize, static_cast<qint64>(block.uncompressedSize));
+    }
+    const int threadCount = static_cast<int>(qBound<qint64>(1, maxQueuedSize / (2 * largestBlockSize), m_threadCount));
+    if (threadCount < m_threadCount) {
+        qCDebug(ARK) << "Using fewer threads for the xz blocks of up to" << largestBlockSize << "bytes";
+    }
+    setThreadCount(threadCount);
+
+    qCDebug(ARK) << "Decompressing" << m_blocks.size() << "xz blocks from" << threadCount << "threads";
+    return true;
+}
+
+bool ParallelXzDecompressor::readStreamIndex(QIODevice *input, qint64 *streamEnd)
+{
+    QByteArray footer;
+    lzma_stream_flags footerFlags;
+    if (!readAt(input, *streamEnd - LZMA_STREAM_HEADER_SIZE, LZMA_STREAM_HEADER_SIZE, &footer)
+            || lzma_stream_footer_decode(&footerFlags, reinterpret_cast<const uint8_t*>(footer.constData())) != LZMA_OK) {
+        return false;
+    }
+
+    QByteArray indexData;
+    const qint64 indexSize = static_cast<qint64>(footerFlags.backward_size);
+    if (!readAt(input, *streamEnd - LZMA_STREAM_HEADER_SIZE - indexSize, indexSize, &indexData)) {
+        return false;
+    }
+
+    lzma_index *index = nullptr;
+    uint64_t memoryLimit = UINT64_MAX;
+    size_t indexPosition = 0;
+    if (lzma_index_buffer_decode(&index, &memoryLimit, nullptr, reinterpret_cast<const uint8_t*>(indexData.constData()),
+                                 &indexPosition, static_cast<size_t>(indexData.size())) != LZMA_OK) {
+        return false;
+    }
+
+    // The header has to match the footer, which gives the integrity check of the blocks.
+    QByteArray header;
+    lzma_stream_flags headerFlags;
+    const qint64 streamStart = *streamEnd - static_cast<qint64>(lzma_index_stream_size(index));
+    const bool valid = lzma_index_stream_flags(index, &footerFlags) == LZMA_OK
+            && readAt(input, streamStart, LZMA_STREAM_HEADER_SIZE, &header)
+            && lzma_stream_header_decode(&headerFlags, reinterpret_cast<const uint8_t*>(header.constData())) == LZMA_OK
+            && lzma_stream_flags_compare(&headerFlags, &footerFlags) == LZMA_OK;
+
+    if (valid) {
+        QVector<Block> blocks;
+        lzma_index_iter iterator;
+        lzma_index_iter_init(&iterator, index);
+        while (!lzma_index_iter_next(&iterator, LZMA_INDEX_ITER_BLOCK)) {
+            Block block;
+            block.offset = streamStart + static_cast<qint64>(iterator.block.compressed_stream_offset);
+            block.totalSize = static_cast<qint64>(iterator.block.total_size);
+            block.unpaddedSize = iterator.block.unpadded_size;
+            block.uncompressedSize = iterator.block.uncompressed_size;
+            block.check = footerFlags.check;
+            blocks << block;
+        }
+        m_blocks = blocks + m_blocks;
+        *streamEnd = streamStart;
+    }
+
+    lzma_index_end(index, nullptr);
+    return valid;
+}
+
+ParallelDecompressor::ChunkStatus ParallelXzDecompressor::readChunk(QIODevice *input, QByteArray *chunk)
+{
+    if (m_nextBlock == m_blocks.size()) {
+        return NoMoreChunks;
+    }
+
+    const Block &block = m_blocks.at(m_nextBlock);
+    if (!readAt(input, block.offset, block.totalSize, chunk)) {
+        return InvalidChunk;
+    }
+
+    m_nextBlock++;
+    return NextChunk;
+}
+
+bool ParallelXzDecompressor::decompressChunk(int index, const QByteArray &chunk, QByteArray *data) const
+{
+    const Block &block = m_blocks.at(index);
+    const uint8_t *in = reinterpret_cast<const uint8_t*>(chunk.constData());
+
+    lzma_filter filters[LZMA_FILTERS_MAX + 1];
+    lzma_block blockOptions = lzma_block();
+    blockOptions.version = 0;
+    blockOptions.check = static_cast<lzma_check>(block.check);
+    blockOptions.filters = filters;
+    blockOptions.header_size = lzma_block_header_size_decode(in[0]);
+    if (blockOptions.header_size > static_cast<uint32_t>(chunk.size())
+            || lzma_block_header_decode(&blockOptions, nullptr, in) != LZMA_OK) {
+        return false;
+    }
+
+    lzma_stream stream = LZMA_STREAM_INIT;
+    bool decompressed = lzma_block_compressed_size(&blockOptions, block.unpaddedSize) == LZMA_OK
+            && lzma_block_decoder(&stream, &blockOptions) == LZMA_OK;
+
+    // The decoder keeps its own copy of the filter options.
+    for (int i = 0; filters[i].id != LZMA_VLI_UNKNOWN; i++) {
+        free(filters[i].options);
+    }
+
+    if (decompressed) {
+        data->resize(static_cast<int>(block.uncompressedSize));
+        stream.next_in = in + blockOptions.header_size;
+        stream.avail_in = static_cast<size_t>(chunk.size()) - blockOptions.header_size;
+        stream.next_out = reinterpret_cast<uint8_t*>(data->data());
+        stream.avail_out = static_cast<size_t>(data->size());
+
+        // The decoder verifies the sizes and the integrity check of the block.
+        decompressed = lzma_code(&stream, LZMA_FINISH) == LZMA_STREAM_END && stream.avail_out == 0;
+    }
+    lzma_end(&stream);
+
+    return decompressed;
+}
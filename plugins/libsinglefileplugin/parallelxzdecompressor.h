@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2026 The Ark developers <kde-utils-devel@kde.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES ( INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION ) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * ( INCLUDING NEGLIGENCE OR OTHERWISE ) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PARALLELXZDECOMPRESSOR_H
+#define PARALLELXZDECOMPRESSOR_H
+
+#include "paralleldecompressor.h"
+
+#include <QVector>
+
+/**
+ * Decompresses the blocks of xz streams from several threads.
+ *
+ * The index at the end of each stream gives the position and sizes of its
+ * blocks, like the ones written by xz --threads. The integrity check of every
+ * block is verified by liblzma. Streams with a single block or with blocks
+ * larger than 512 MiB are not decompressed in parallel, and large blocks are
+ * decompressed from fewer threads so that the queued blocks fit in memory.
+ */
+class ParallelXzDecompressor : public ParallelDecompressor
+{
+public:
+    explicit ParallelXzDecompressor(int threadCount);
+
+protected:
+    bool open(QIODevice *input) override;
+    ChunkStatus readChunk(QIODevice *input, QByteArray *chunk) override;
+    bool decompressChunk(int index, const QByteArray &chunk, QByteArray *data) const override;
+
+private:
+    struct Block
+    {
+        qint64 offset;
+        qint64 totalSize;
+        quint64 unpaddedSize;
+        quint64 uncompressedSize;
+        int check;
+    };
+
+    /**
+     * Reads the index of the stream ending at @p streamEnd and prepends its blocks.
+     * @p streamEnd is then moved to the start of the stream.
+     */
+    bool readStreamIndex(QIODevice *input, qint64 *streamEnd);
+
+    const int m_threadCount;
+    QVector<Block> m_blocks;
+    int m_nextBlock;
+};
+
+#endif // PARALLELXZDECOMPRESSOR_H
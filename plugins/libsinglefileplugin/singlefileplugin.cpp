@@ -25,10 +25,13 @@
 
 #include "singlefileplugin.h"
 #include "ark_debug.h"
+#include "paralleldecompressor.h"
 #include "queries.h"
 
 #include <QFile>
 #include <QFileInfo>
+#include <QScopedPointer>
+#include <QThread>
 
 #include <KFilterDev>
 #include <KLocalizedString>
@@ -69,37 +72,91 @@ bool LibSingleFileInterface::extractFiles(const QVector<Kerfuffle::Archive::Entr
         return false;
     }
 
-    KCompressionDevice *device = new KCompressionDevice(filename(), KFilterDev::compressionTypeForMimeType(m_mimeType));
-    if (!device) {
-        qCCritical(ARK) << "Could not create KCompressionDevice";
+    QFile inputFile(filename());
+    if (!inputFile.open(QIODevice::ReadOnly)) {
+        qCCritical(ARK) << "Failed to open input file" << inputFile.errorString();
         emit error(xi18nc("@info", "Ark could not open <filename>%1</filename> for extraction.", filename()));
 
         return false;
     }
 
-    device->open(QIODevice::ReadOnly);
+    const int threadCount = QThread::idealThreadCount();
+    QScopedPointer<ParallelDecompressor> decompressor(threadCount > 1 ? createParallelDecompressor(threadCount) : nullptr);
+    if (decompressor) {
+        connect(decompressor.data(), &ParallelDecompressor::progress, this, &LibSingleFileInterface::progress);
+
+        switch (decompressor->decompress(&inputFile, &outputFile)) {
+        case ParallelDecompressor::Decompressed:
+            return true;
+        case ParallelDecompressor::Cancelled:
+            return false;
+        case ParallelDecompressor::WriteError:
+            emit error(xi18nc("@info", "Ark could not extract <filename>%1</filename>.", outputFile.fileName()));
+            return false;
+        case ParallelDecompressor::InvalidData:
+            // Start again from a single thread, which reports the errors in the data if there are any.
+            qCDebug(ARK) << "Could not decompress in parallel, decompressing from a single thread";
+            if (!inputFile.seek(0) || !outputFile.resize(0) || !outputFile.seek(0)) {
+                emit error(xi18nc("@info", "Ark could not extract <filename>%1</filename>.", outputFile.fileName()));
+                return false;
+            }
+            break;
+        }
+    }
+
+    // The compression device reads from inputFile, whose position gives the progress.
+    KCompressionDevice device(&inputFile, false, KFilterDev::compressionTypeForMimeType(m_mimeType));
+    if (!device.open(QIODevice::ReadOnly)) {
+        qCCritical(ARK) << "Could not open the compression device";
+        emit error(xi18nc("@info", "Ark could not open <filename>%1</filename> for extraction.", filename()));
 
-    qint64 bytesRead;
-    QByteArray dataChunk(1024*16, '\0');   // 16Kb
+        return false;
+    }
+
+    const qint64 inputSize = inputFile.size();
+    int lastProgress = -1;
+    QByteArray dataChunk(1024 * 1024, '\0');
 
-    while (true) {
-        bytesRead = device->read(dataChunk.data(), dataChunk.size());
+    while (!QThread::currentThread()->isInterruptionRequested()) {
+        const qint64 bytesRead = device.read(dataChunk.data(), dataChunk.size());
 
         if (bytesRead == -1) {
             emit error(xi18nc("@info", "There was an error while reading <filename>%1</filename> during extraction.", filename()));
-            break;
+            return false;
         } else if (bytesRead == 0) {
-            break;
+            return true;
         }
 
-        outputFile.write(dataChunk.data(), bytesRead);
+        if (outputFile.write(dataChunk.constData(), bytesRead) != bytesRead) {
+            qCCritical(ARK) << "Failed to write to output file" << outputFile.errorString();
+            emit error(xi18nc("@info", "Ark could not extract <filename>%1</filename>.", outputFile.fileName()));
+            return false;
+        }
+
+        // Only emit when the permille changes, not for every chunk.
+        if (inputSize > 0) {
+            const int readProgress = static_cast<int>(1000 * inputFile.pos() / inputSize);
+            if (readProgress != lastProgress) {
+                lastProgress = readProgress;
+                emit progress(readProgress / 1000.0);
+            }
+        }
     }
 
-    delete device;
+    return false;
+}
 
+bool LibSingleFileInterface::doKill()
+{
     return true;
 }
 
+ParallelDecompressor *LibSingleFileInterface::createParallelDecompressor(int threadCount) const
+{
+    Q_UNUSED(threadCount)
+    return nullptr;
+}
+
 bool LibSingleFileInterface::list()
 {
     qCDebug(ARK) << "Listing archive contents";
@@ -28,6 +28,8 @@
 
 #include "archiveinterface.h"
 
+class ParallelDecompressor;
+
 class LibSingleFileInterface : public Kerfuffle::ReadOnlyArchiveInterface
 {
     Q_OBJECT
@@ -39,11 +41,20 @@ public:
     bool list() override;
     bool testArchive() override;
     bool extractFiles(const QVector<Kerfuffle::Archive::Entry*> &files, const QString &destinationDirectory, const Kerfuffle::ExtractionOptions &options) override;
+    bool doKill() override;
 
 protected:
     const QString uncompressedFileName() const;
     QString overwriteFileName(QString& filename);
 
+    /**
+     * @return A decompressor splitting the data of the archive between @p threadCount
+     * threads, or nullptr if the format cannot be decompressed in parallel.
+     *
+     * The default implementation returns nullptr.
+     */
+    virtual ParallelDecompressor *createParallelDecompressor(int threadCount) const;
+
     QString m_mimeType;
     QStringList m_possibleExtensions;
 };
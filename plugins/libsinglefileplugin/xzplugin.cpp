@@ -25,6 +25,7 @@
 
 #include "xzplugin.h"
 #include "kerfuffle_export.h"
+#include "parallelxzdecompressor.h"
 
 #include <QString>
 
@@ -44,4 +45,9 @@ LibXzInterface::~LibXzInterface()
 {
 }
 
+ParallelDecompressor *LibXzInterface::createParallelDecompressor(int threadCount) const
+{
+    return new ParallelXzDecompressor(threadCount);
+}
+
 #include "xzplugin.moc"
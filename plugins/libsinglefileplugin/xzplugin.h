@@ -35,6 +35,9 @@ class KERFUFFLE_EXPORT LibXzInterface : public LibSingleFileInterface
 public:
     LibXzInterface(QObject *parent, const QVariantList & args);
     ~LibXzInterface() override;
+
+protected:
+    ParallelDecompressor *createParallelDecompressor(int threadCount) const override;
 };
 
 #endif // XZPLUGIN_H
@@ -69,6 +69,7 @@
             "AES192",
             "AES128"
         ],
+        "SupportsMultithreading": true,
         "SupportsTesting": true,
         "SupportsWriteComment": true
     }
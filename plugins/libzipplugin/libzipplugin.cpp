@@ -25,21 +25,141 @@
 
 #include "libzipplugin.h"
 #include "ark_debug.h"
+#include "parallelzipcompressor.h"
 #include "queries.h"
 
 #include <KIO/Global>
 #include <KLocalizedString>
 #include <KPluginFactory>
 
-#include <QDataStream>
 #include <QDateTime>
 #include <QDir>
-#include <QDirIterator>
 #include <QFile>
+#include <QMutex>
+#include <QPair>
+#include <QRunnable>
+#include <QScopedPointer>
 #include <QThread>
+#include <QThreadPool>
+
+#include <algorithm>
 
 K_PLUGIN_FACTORY_WITH_JSON(LibZipPluginFactory, "kerfuffle_libzip.json", registerPlugin<LibzipPlugin>();)
 
+// The size of the buffer used to extract the entries.
+static const int extractBufferSize = 1024 * 1024;
+
+// How often the progress is emitted while extracting, in milliseconds.
+static const int progressInterval = 100;
+
+struct LibzipPlugin::ExtractionState
+{
+    /**
+     * @param testOnly Whether the entries are only read, for testing them.
+     */
+    ExtractionState(const QVector<ExtractedEntry> &entries, bool testOnly)
+        : entries(entries)
+        , testOnly(testOnly)
+    {
+    }
+
+    void fail(const QString &message)
+    {
+        QMutexLocker locker(&mutex);
+        if (!failed.loadAcquire()) {
+            errorMessage = message;
+            failed.storeRelease(1);
+        }
+    }
+
+    void failTest(const QString &entry, const QString &reason)
+    {
+        QMutexLocker locker(&mutex);
+        failedEntries.append(qMakePair(entry, reason));
+    }
+
+    const QVector<ExtractedEntry> &entries;
+    const bool testOnly;
+    QAtomicInt nextEntry;
+    QAtomicInt extractedCount;
+    QAtomicInt cancelled;
+    QAtomicInt failed;
+    QMutex mutex;
+    QString errorMessage;
+    // The entries which failed the test, with the reason.
+    QVector<QPair<QString, QString> > failedEntries;
+};
+
+// Extracts or tests entries of the shared list until none is left. The entries are
+// taken in order, so that the archive is read mostly sequentially.
+class LibzipPlugin::ExtractTask : public QRunnable
+{
+public:
+    /**
+     * @param archive The handle to read the archive with, or nullptr for
+     * opening a new one.
+     */
+    ExtractTask(ExtractionState *state, zip_t *archive, const QString &fileName, const QString &password)
+        : m_state(state)
+        , m_archive(archive)
+        , m_fileName(fileName)
+        , m_password(password)
+    {
+    }
+
+    void run() override
+    {
+        zip_t *archive = m_archive;
+        if (!archive) {
+            int errcode;
+            archive = zip_open(QFile::encodeName(m_fileName), ZIP_RDONLY, &errcode);
+            if (!archive) {
+                zip_error_t err;
+                zip_error_init_with_code(&err, errcode);
+                qCCritical(ARK) << "Failed to open archive. Code:" << errcode;
+                m_state->fail(xi18n("Failed to open archive: %1", QString::fromUtf8(zip_error_strerror(&err))));
+                zip_error_fini(&err);
+                return;
+            }
+            if (!m_password.isEmpty()) {
+                zip_set_default_password(archive, m_password.toUtf8());
+            }
+        }
+
+        QByteArray buffer(extractBufferSize, Qt::Uninitialized);
+        QString errorMessage;
+        while (!m_state->cancelled.loadAcquire() && !m_state->failed.loadAcquire()) {
+            const int i = m_state->nextEntry.fetchAndAddOrdered(1);
+            if (i >= m_state->entries.size()) {
+                break;
+            }
+            if (!LibzipPlugin::extractEntryData(archive, m_state->entries.at(i), m_state->testOnly, buffer, m_state->cancelled, &errorMessage)) {
+                if (m_state->cancelled.loadAcquire()) {
+                    break;
+                }
+                // A failed test does not prevent testing the next entries.
+                if (m_state->testOnly) {
+                    m_state->failTest(m_state->entries.at(i).path, errorMessage);
+                } else {
+                    m_state->fail(errorMessage);
+                    break;
+                }
+            }
+            m_state->extractedCount.fetchAndAddOrdered(1);
+        }
+
+        if (archive != m_archive) {
+            zip_discard(archive);
+        }
+    }
+
+private:
+    ExtractionState *m_state;
+    zip_t *m_archive;
+    const QString m_fileName;
+    const QString m_password;
+};
+
 // This is needed for hooking a C callback to a C++ non-static member
 // function.
 template <typename T>
@@ -58,7 +178,6 @@ LibzipPlugin::LibzipPlugin(QObject *parent, const QVariantList & args)
     : ReadWriteArchiveInterface(parent, args)
     , m_overwriteAll(false)
     , m_skipAll(false)
-    , m_listAfterAdd(false)
 {
     qCDebug(ARK) << "Initializing libzip plugin";
 }
@@ -104,16 +223,11 @@ bool LibzipPlugin::list()
         }
 
         emitEntryForIndex(archive, i);
-        if (m_listAfterAdd) {
-            // Start at 50%.
-            emit progress(0.5 + (0.5 * float(i + 1) / nofEntries));
-        } else {
-            emit progress(float(i + 1) / nofEntries);
-        }
+        emit progress(float(i + 1) / nofEntries);
     }
+    flushEntries();
 
     zip_close(archive);
-    m_listAfterAdd = false;
     return true;
 }
 
@@ -133,43 +247,44 @@ bool LibzipPlugin::addFiles(const QVector<Archive::Entry*> &files, const Archive
         return false;
     }
 
+    const FileManifest manifest = takeFileManifest(files);
+
+    // Symlinks to directories are added as directories.
+    QVector<bool> isDirectory;
+    QStringList filePaths;
+    isDirectory.reserve(manifest.count());
+    foreach (const FileManifest::File &file, manifest.files()) {
+        const bool isDir = file.isDir || (file.isSymLink && QFileInfo(file.path).isDir());
+        isDirectory.append(isDir);
+        if (!isDir) {
+            filePaths << file.path;
+        }
+    }
+
+    // With several threads, the files are deflated before zip_close(),
+    // which then only copies the compressed data. The large ones are
+    // spilled next to the archive.
+    QScopedPointer<ParallelZipCompressor> compressor;
+    if (options.numberOfThreads() > 1 && filePaths.size() > 1) {
+        compressor.reset(new ParallelZipCompressor(filePaths, options.numberOfThreads(), QFileInfo(filename()).absolutePath()));
+    }
+
     uint i = 0;
-    foreach (const Archive::Entry* e, files) {
+    int compressedFiles = 0;
+    QVector<qlonglong> addedIndices;
+    addedIndices.reserve(numberOfEntriesToAdd);
+    for (int j = 0; j < manifest.count(); j++) {
 
         if (QThread::currentThread()->isInterruptionRequested()) {
             break;
         }
 
-        // If entry is a directory, traverse and add all its files and subfolders.
-        if (QFileInfo(e->fullPath()).isDir()) {
-
-            if (!writeEntry(archive, e->fullPath(), destination, options, true)) {
-                return false;
-            }
-
-            QDirIterator it(e->fullPath(),
-                            QDir::AllEntries | QDir::Readable |
-                            QDir::Hidden | QDir::NoDotAndDotDot,
-                            QDirIterator::Subdirectories);
-
-            while (!QThread::currentThread()->isInterruptionRequested() && it.hasNext()) {
-                QString path = it.next();
-
-                if (QFileInfo(path).isDir()) {
-                    if (!writeEntry(archive, path, destination, options, true)) {
-                        return false;
-                    }
-                } else {
-                    if (!writeEntry(archive, path, destination, options)) {
-                        return false;
-                    }
-                }
-                i++;
-            }
-        } else {
-            if (!writeEntry(archive, e->fullPath(), destination, options)) {
-                return false;
-            }
+        zip_source_t *source = nullptr;
+        if (compressor && !isDirectory.at(j)) {
+            source = compressor->source(archive, compressedFiles++);
+        }
+        if (!writeEntry(archive, manifest.files().at(j).path, destination, options, isDirectory.at(j), source, addedIndices)) {
+            return false;
         }
         i++;
     }
@@ -187,21 +302,49 @@ bool LibzipPlugin::addFiles(const QVector<Archive::Entry*> &files, const Archive
         return false;
     }
 
-    // We list the entire archive after adding files to ensure entry
-    // properties are up-to-date.
-    m_listAfterAdd = true;
-    list();
+    // Emit the added entries again, now that their properties are known.
+    return emitAddedEntries(addedIndices);
+}
+
+bool LibzipPlugin::emitAddedEntries(QVector<qlonglong> indices)
+{
+    int errcode;
+    zip_error_t err;
+
+    zip_t *archive = zip_open(QFile::encodeName(filename()), ZIP_RDONLY, &errcode);
+    zip_error_init_with_code(&err, errcode);
+    if (!archive) {
+        qCCritical(ARK) << "Failed to open archive. Code:" << errcode;
+        emit error(xi18n("Failed to open archive: %1", QString::fromUtf8(zip_error_strerror(&err))));
+        return false;
+    }
+
+    // An entry added twice keeps its index.
+    std::sort(indices.begin(), indices.end());
+    indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+
+    // As no entry is deleted while adding, the indices are the same in the written archive.
+    for (int i = 0; i < indices.size(); i++) {
+        emitEntryForIndex(archive, indices.at(i));
+        // Start at 50%.
+        emit progress(0.5 + (0.5 * float(i + 1) / indices.size()));
+    }
+    flushEntries();
+
+    // The entries which replaced existing ones have been counted again.
+    m_numberOfEntries = zip_get_num_entries(archive, 0);
 
+    zip_close(archive);
     return true;
 }
 
 void LibzipPlugin::progressEmitted(double pct)
 {
-    // Go from 0 to 50%. The second half is the subsequent listing.
+    // Go from 0 to 50%. The second half is the emission of the added entries.
     emit progress(0.5 * pct);
 }
 
-bool LibzipPlugin::writeEntry(zip_t *archive, const QString &file, const Archive::Entry* destination, const CompressionOptions& options, bool isDir)
+bool LibzipPlugin::writeEntry(zip_t *archive, const QString &file, const Archive::Entry* destination, const CompressionOptions& options, bool isDir, zip_source_t *source, QVector<qlonglong> &addedIndices)
 {
     Q_ASSERT(archive);
 
@@ -221,7 +364,7 @@ bool LibzipPlugin::writeEntry(zip_t *archive, const QString &file, const Archive
             return true;
         }
     } else {
-        zip_source_t *src = zip_source_file(archive, QFile::encodeName(file).constData(), 0, -1);
+        zip_source_t *src = source ? source : zip_source_file(archive, QFile::encodeName(file).constData(), 0, -1);
         Q_ASSERT(src);
 
         index = zip_file_add(archive, destFile, src, ZIP_FL_ENC_GUESS | ZIP_FL_OVERWRITE);
@@ -232,6 +375,8 @@ bool LibzipPlugin::writeEntry(zip_t *archive, const QString &file, const Archive
             return false;
         }
     }
+    addedIndices.append(index);
+
     if (!password().isEmpty()) {
         Q_ASSERT(!options.encryptionMethod().isEmpty());
         if (options.encryptionMethod() == QLatin1String("AES128")) {
@@ -328,7 +473,7 @@ bool LibzipPlugin::emitEntryForIndex(zip_t *archive, qlonglong index)
         }
     }
 
-    emit entry(e);
+    queueEntry(e);
     m_emittedEntries << e;
 
     return true;
@@ -421,9 +566,53 @@ bool LibzipPlugin::testArchive()
         qCCritical(ARK) << "Failed to open archive:" << zip_error_strerror(&err);
         return false;
     }
+
+    if (!password().isEmpty()) {
+        zip_set_default_password(archive, password().toUtf8());
+    }
+
+    // Read the data of every file, which makes libzip check its CRC.
+    // Computing the CRC costs much less than inflating the data, and both
+    // are spread over the threads, so zlib's crc32() is fast enough.
+    QVector<ExtractedEntry> entries;
+    const qlonglong nofEntries = zip_get_num_entries(archive, 0);
+    entries.reserve(nofEntries);
+    for (qlonglong i = 0; i < nofEntries; i++) {
+        ExtractedEntry entry;
+        entry.index = i;
+        entry.path = QDir::fromNativeSeparators(QString::fromUtf8(zip_get_name(archive, i, ZIP_FL_ENC_GUESS)));
+        if (!entry.path.endsWith(QDir::separator())) {
+            entries.append(entry);
+        }
+    }
+
+    if (!queryPassword(archive, entries)) {
+        zip_close(archive);
+        return false;
+    }
+
+    ExtractionState state(entries, true);
+    runExtractTasks(archive, state);
     zip_close(archive);
 
-    emit testSuccess();
+    if (state.cancelled.loadAcquire()) {
+        return true;
+    }
+
+    if (state.failed.loadAcquire()) {
+        emit error(state.errorMessage);
+        return false;
+    }
+
+    typedef QPair<QString, QString> FailedEntry;
+    foreach (const FailedEntry &failedEntry, state.failedEntries) {
+        qCWarning(ARK) << "Entry" << failedEntry.first << "failed the test:" << failedEntry.second;
+        emit testFailure(failedEntry.first, failedEntry.second);
+    }
+
+    if (state.failedEntries.isEmpty()) {
+        emit testSuccess();
+    }
     return true;
 }
 
@@ -458,56 +647,93 @@ bool LibzipPlugin::extractFiles(const QVector<Archive::Entry*> &files, const QSt
         zip_set_default_password(archive, password().toUtf8());
     }
 
-    // Get number of archive entries.
-    qlonglong nofEntries;
-    extractAll ? nofEntries = zip_get_num_entries(archive, 0) : nofEntries = files.size();
-
-    // Extract entries.
-    m_overwriteAll = false; // Whether to overwrite all files
-    m_skipAll = false; // Whether to skip all files
+    // Resolve the index of every entry to extract once, so that the
+    // entries do not have to be looked up by name again.
+    QVector<ExtractedEntry> plan;
     if (extractAll) {
-        // We extract all entries.
+        const qlonglong nofEntries = zip_get_num_entries(archive, 0);
+        plan.reserve(nofEntries);
         for (qlonglong i = 0; i < nofEntries; i++) {
-            if (QThread::currentThread()->isInterruptionRequested()) {
-                break;
-            }
-            if (!extractEntry(archive,
-                              QDir::fromNativeSeparators(QString::fromUtf8(zip_get_name(archive, i, ZIP_FL_ENC_GUESS))),
-                              QString(),
-                              destinationDirectory,
-                              options.preservePaths(),
-                              removeRootNode)) {
-                qCDebug(ARK) << "Extraction failed";
-                return false;
-            }
-            emit progress(float(i + 1) / nofEntries);
+            ExtractedEntry entry;
+            entry.index = i;
+            entry.path = QDir::fromNativeSeparators(QString::fromUtf8(zip_get_name(archive, i, ZIP_FL_ENC_GUESS)));
+            plan.append(entry);
         }
     } else {
-        // We extract only the entries in files.
-        qulonglong i = 0;
+        plan.reserve(files.size());
         foreach (const Archive::Entry* e, files) {
-            if (QThread::currentThread()->isInterruptionRequested()) {
-                break;
+            ExtractedEntry entry;
+            entry.path = e->fullPath();
+            entry.rootNode = e->rootNode;
+            // Many archives have no records for their directories, which are
+            // then only created, so they are not looked up.
+            if (entry.path.endsWith(QLatin1Char('/'))) {
+                entry.index = -1;
+                plan.append(entry);
+                continue;
             }
-            if (!extractEntry(archive,
-                              e->fullPath(),
-                              e->rootNode,
-                              destinationDirectory,
-                              options.preservePaths(),
-                              removeRootNode)) {
-                qCDebug(ARK) << "Extraction failed";
+            entry.index = zip_name_locate(archive, e->fullPath().toUtf8(), ZIP_FL_ENC_GUESS);
+            if (entry.index == -1) {
+                qCCritical(ARK) << "Could not locate entry:" << e->fullPath();
+                emit error(xi18n("Failed to locate entry: %1", e->fullPath()));
+                zip_close(archive);
                 return false;
             }
-            emit progress(float(++i) / nofEntries);
+            plan.append(entry);
+        }
+    }
+
+    // Handle the directories and the existing files, which may need to ask
+    // the user, before extracting the data from several threads.
+    m_overwriteAll = false; // Whether to overwrite all files
+    m_skipAll = false; // Whether to skip all files
+    m_createdDirectories.clear();
+    m_plannedDestinations.clear();
+
+    bool isSuccessful = true;
+    for (int i = 0; i < plan.size(); i++) {
+        if (QThread::currentThread()->isInterruptionRequested()) {
+            break;
+        }
+        if (!prepareEntry(plan, i, destinationDirectory, options.preservePaths(), removeRootNode)) {
+            qCDebug(ARK) << "Extraction failed";
+            isSuccessful = false;
+            break;
+        }
+    }
+
+    m_createdDirectories.clear();
+    m_plannedDestinations.clear();
+
+    QVector<ExtractedEntry> writtenEntries;
+    writtenEntries.reserve(plan.size());
+    foreach (const ExtractedEntry &entry, plan) {
+        if (!entry.destination.isEmpty()) {
+            writtenEntries.append(entry);
         }
     }
 
+    // Read the entries in the order of their data in the archive. libzip does
+    // not give the offsets of the local headers, but the central directory
+    // lists the entries in that order in the archives written by every
+    // common tool.
+    std::sort(writtenEntries.begin(), writtenEntries.end(), [](const ExtractedEntry &a, const ExtractedEntry &b) {
+        return a.index < b.index;
+    });
+
+    if (isSuccessful && !QThread::currentThread()->isInterruptionRequested() && !writtenEntries.isEmpty()) {
+        isSuccessful = queryPassword(archive, writtenEntries) && extractEntries(archive, writtenEntries);
+    }
+
     zip_close(archive);
-    return true;
+    return isSuccessful;
 }
 
-bool LibzipPlugin::extractEntry(zip_t *archive, const QString &entry, const QString &rootNode, const QString &destDir, bool preservePaths, bool removeRootNode)
+bool LibzipPlugin::prepareEntry(QVector<ExtractedEntry> &plan, int planIndex, const QString &destDir, bool preservePaths, bool removeRootNode)
 {
+    ExtractedEntry &extractedEntry = plan[planIndex];
+    const QString &entry = extractedEntry.path;
+    const QString &rootNode = extractedEntry.rootNode;
     const bool isDirectory = entry.endsWith(QDir::separator());
 
     // Add trailing slash to destDir if not present.
@@ -535,19 +761,26 @@ bool LibzipPlugin::extractEntry(zip_t *archive, const QString &entry, const QStr
     }
 
     // Create parent directories for files. For directories create them.
-    if (!QDir().mkpath(QFileInfo(destination).path())) {
-        qCDebug(ARK) << "Failed to create directory:" << QFileInfo(destination).path();
-        emit error(xi18n("Failed to create directory: %1", QFileInfo(destination).path()));
-        return false;
+    // Most entries share their parent with the previous ones, so the
+    // directories created during this extraction are not created again.
+    const QString parentDirectory = QFileInfo(destination).path();
+    if (!m_createdDirectories.contains(parentDirectory)) {
+        if (!QDir().mkpath(parentDirectory)) {
+            qCDebug(ARK) << "Failed to create directory:" << parentDirectory;
+            emit error(xi18n("Failed to create directory: %1", parentDirectory));
+            return false;
+        }
+        m_createdDirectories.insert(parentDirectory);
     }
 
     if (isDirectory) {
         return true;
     }
 
-    // Handle existing destination files.
+    // Handle existing destination files. The files of the entries planned
+    // so far do not exist yet, but they are handled the same way.
     QString renamedEntry = entry;
-    while (!m_overwriteAll && QFileInfo::exists(destination)) {
+    while (!m_overwriteAll && (QFileInfo::exists(destination) || m_plannedDestinations.contains(destination))) {
         if (m_skipAll) {
             return true;
         } else {
@@ -575,84 +808,162 @@ bool LibzipPlugin::extractEntry(zip_t *archive, const QString &entry, const QStr
         }
     }
 
-    // Handle password-protected files.
-    zip_file *zf = nullptr;
-    bool firstTry = true;
-    while (!zf) {
-        zf = zip_fopen(archive, entry.toUtf8(), 0);
-        if (zf) {
-            break;
-        } else if (zip_error_code_zip(zip_get_error(archive)) == ZIP_ER_NOPASSWD ||
-                   zip_error_code_zip(zip_get_error(archive)) == ZIP_ER_WRONGPASSWD) {
-            Kerfuffle::PasswordNeededQuery query(filename(), !firstTry);
-            emit userQuery(&query);
-            query.waitForResponse();
+    // Only the last entry planned for a file is extracted, so that no two
+    // threads write the same file.
+    const auto planned = m_plannedDestinations.constFind(destination);
+    if (planned != m_plannedDestinations.constEnd()) {
+        plan[planned.value()].destination.clear();
+    }
+    m_plannedDestinations.insert(destination, planIndex);
+    extractedEntry.destination = destination;
 
-            if (query.responseCancelled()) {
-                emit cancelled();
-                return false;
-            }
-            setPassword(query.password());
+    return true;
+}
 
-            if (zip_set_default_password(archive, password().toUtf8())) {
-                qCDebug(ARK) << "Failed to set password for:" << entry;
+bool LibzipPlugin::queryPassword(zip_t *archive, const QVector<ExtractedEntry> &entries)
+{
+    // The extracting threads cannot ask for the password, so it is checked
+    // on the first encrypted entry beforehand.
+    foreach (const ExtractedEntry &entry, entries) {
+        zip_stat_t sb;
+        if (zip_stat_index(archive, entry.index, 0, &sb) != 0 ||
+            !(sb.valid & ZIP_STAT_ENCRYPTION_METHOD) || sb.encryption_method == ZIP_EM_NONE) {
+            continue;
+        }
+
+        zip_file *zf = nullptr;
+        bool firstTry = true;
+        while (!zf) {
+            zf = zip_fopen_index(archive, entry.index, 0);
+            if (zf) {
+                break;
+            } else if (zip_error_code_zip(zip_get_error(archive)) == ZIP_ER_NOPASSWD ||
+                       zip_error_code_zip(zip_get_error(archive)) == ZIP_ER_WRONGPASSWD) {
+                Kerfuffle::PasswordNeededQuery query(filename(), !firstTry);
+                emit userQuery(&query);
+                query.waitForResponse();
+
+                if (query.responseCancelled()) {
+                    emit cancelled();
+                    return false;
+                }
+                setPassword(query.password());
+
+                if (zip_set_default_password(archive, password().toUtf8())) {
+                    qCDebug(ARK) << "Failed to set password for:" << entry.path;
+                }
+                firstTry = false;
+            } else {
+                qCCritical(ARK) << "Failed to open file:" << zip_strerror(archive);
+                emit error(xi18n("Failed to open '%1':<nl/>%2", entry.path, QString::fromUtf8(zip_strerror(archive))));
+                return false;
             }
-            firstTry = false;
-        } else {
-            qCCritical(ARK) << "Failed to open file:" << zip_strerror(archive);
-            emit error(xi18n("Failed to open '%1':<nl/>%2", entry, QString::fromUtf8(zip_strerror(archive))));
-            return false;
         }
+        zip_fclose(zf);
+        break;
     }
 
-    QFile file(destination);
-    if (!file.open(QIODevice::WriteOnly)) {
-        qCCritical(ARK) << "Failed to open file for writing";
-        emit error(xi18n("Failed to open file for writing: %1", destination));
+    return true;
+}
+
+bool LibzipPlugin::extractEntries(zip_t *archive, const QVector<ExtractedEntry> &entries)
+{
+    ExtractionState state(entries, false);
+    runExtractTasks(archive, state);
+
+    if (state.failed.loadAcquire()) {
+        emit error(state.errorMessage);
         return false;
     }
 
-    QDataStream out(&file);
+    return true;
+}
 
-    // Get statistic for entry. Used below to get entry size.
-    zip_stat_t sb;
-    if (zip_stat(archive, entry.toUtf8(), 0, &sb) != 0) {
-        qCCritical(ARK) << "Failed to read stat for entry" << entry;
-        return false;
+void LibzipPlugin::runExtractTasks(zip_t *archive, ExtractionState &state)
+{
+    if (state.entries.isEmpty()) {
+        return;
     }
 
-    // Write archive entry to file. We use a read/write buffer of 1000 chars.
-    qulonglong sum = 0;
-    char buf[1000];
-    int len;
-    while (sum != sb.size) {
-        len = zip_fread(zf, buf, 1000);
-        if (len < 0) {
-            qCCritical(ARK) << "Failed to read data";
-            emit error(xi18n("Failed to read data for entry: %1", entry));
-            return false;
+    // Every thread but the first one reads the archive through its own handle.
+    const int threadCount = qBound(1, QThread::idealThreadCount(), state.entries.size());
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(threadCount);
+    for (int i = 0; i < threadCount; i++) {
+        threadPool.start(new ExtractTask(&state, i == 0 ? archive : nullptr, filename(), password()));
+    }
+    qCDebug(ARK) << "Reading" << state.entries.size() << "entries with" << threadCount << "threads";
+
+    while (!threadPool.waitForDone(progressInterval)) {
+        if (QThread::currentThread()->isInterruptionRequested()) {
+            state.cancelled.storeRelease(1);
         }
-        if (out.writeRawData(buf, len) != len) {
+        emit progress(float(state.extractedCount.loadAcquire()) / state.entries.size());
+    }
+
+    if (!state.cancelled.loadAcquire() && !state.failed.loadAcquire()) {
+        emit progress(1.0);
+    }
+}
+
+bool LibzipPlugin::extractEntryData(zip_t *archive, const ExtractedEntry &entry, bool isTested, QByteArray &buffer, const QAtomicInt &cancelled, QString *errorMessage)
+{
+    zip_file *zf = zip_fopen_index(archive, entry.index, 0);
+    if (!zf) {
+        qCCritical(ARK) << "Failed to open file:" << zip_strerror(archive);
+        *errorMessage = isTested
+                        ? QString::fromUtf8(zip_strerror(archive))
+                        : xi18n("Failed to open '%1':<nl/>%2", entry.path, QString::fromUtf8(zip_strerror(archive)));
+        return false;
+    }
+
+    // The data is written in large blocks, so QFile does not need to buffer it.
+    QFile file(entry.destination);
+    if (!isTested && !file.open(QIODevice::WriteOnly | QIODevice::Unbuffered)) {
+        qCCritical(ARK) << "Failed to open file for writing";
+        *errorMessage = xi18n("Failed to open file for writing: %1", entry.destination);
+        zip_fclose(zf);
+        return false;
+    }
+
+    // Write archive entry to file.
+    char *buf = buffer.data();
+    zip_int64_t len = 0;
+    while (!cancelled.loadAcquire() && (len = zip_fread(zf, buf, buffer.size())) > 0) {
+        if (!isTested && file.write(buf, len) != len) {
             qCCritical(ARK) << "Failed to write data";
-            emit error(xi18n("Failed to write data for entry: %1", entry));
+            *errorMessage = xi18n("Failed to write data for entry: %1", entry.path);
+            zip_fclose(zf);
             return false;
         }
-
-        sum += len;
     }
+    if (len < 0) {
+        qCCritical(ARK) << "Failed to read data:" << zip_file_strerror(zf);
+        // The test report gives the reason, such as a CRC error, next to the entry.
+        *errorMessage = isTested ? QString::fromUtf8(zip_file_strerror(zf))
+                                 : xi18n("Failed to read data for entry: %1", entry.path);
+        zip_fclose(zf);
+        return false;
+    }
+    zip_fclose(zf);
 
-    const auto index = zip_name_locate(archive, entry.toUtf8(), ZIP_FL_ENC_GUESS);
-    if (index == -1) {
-        qCCritical(ARK) << "Could not locate entry:" << entry;
-        emit error(xi18n("Failed to locate entry: %1", entry));
+    // Do not leave a truncated file behind when cancelled during the entry.
+    if (cancelled.loadAcquire()) {
+        if (!isTested) {
+            file.remove();
+        }
         return false;
     }
 
+    if (isTested) {
+        return true;
+    }
+
     zip_uint8_t opsys;
     zip_uint32_t attributes;
-    if (zip_file_get_external_attributes(archive, index, ZIP_FL_UNCHANGED, &opsys, &attributes) == -1) {
-        qCCritical(ARK) << "Could not read external attributes for entry:" << entry;
-        emit error(xi18n("Failed to read metadata for entry: %1", entry));
+    if (zip_file_get_external_attributes(archive, entry.index, ZIP_FL_UNCHANGED, &opsys, &attributes) == -1) {
+        qCCritical(ARK) << "Could not read external attributes for entry:" << entry.path;
+        *errorMessage = xi18n("Failed to read metadata for entry: %1", entry.path);
         return false;
     }
 
@@ -666,7 +977,6 @@ bool LibzipPlugin::extractEntry(zip_t *archive, const QString &entry, const QStr
         break;
     }
 
-
     return true;
 }
 
@@ -710,6 +1020,7 @@ bool LibzipPlugin::moveFiles(const QVector<Archive::Entry*> &files, Archive::Ent
         emitEntryForIndex(archive, index);
         emit progress(i/filePaths.count());
     }
+    flushEntries();
     if (zip_close(archive)) {
         qCCritical(ARK) << "Failed to write archive";
         emit error(xi18n("Failed to write archive."));
@@ -776,6 +1087,7 @@ bool LibzipPlugin::copyFiles(const QVector<Archive::Entry*> &files, Archive::Ent
         emitEntryForIndex(archive, destIndex);
         emit progress(i/filePaths.count());
     }
+    flushEntries();
     if (zip_close(archive)) {
         qCCritical(ARK) << "Failed to write archive";
         emit error(xi18n("Failed to write archive."));
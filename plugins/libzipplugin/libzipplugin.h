@@ -28,6 +28,10 @@
 
 #include "archiveinterface.h"
 
+#include <QAtomicInt>
+#include <QHash>
+#include <QSet>
+
 #include <zip.h>
 
 using namespace Kerfuffle;
@@ -52,15 +56,65 @@ public:
     bool testArchive() override;
 
 private:
-    bool extractEntry(zip_t *archive, const QString &entry, const QString &rootNode, const QString &destDir, bool preservePaths, bool removeRootNode);
-    bool writeEntry(zip_t *archive, const QString &entry, const Archive::Entry* destination, const CompressionOptions& options, bool isDir = false);
+    struct ExtractedEntry
+    {
+        // -1 for the selected directories, which are not looked up.
+        qlonglong index;
+        QString path;
+        QString rootNode;
+        // The file the entry is extracted to, empty if its data is not extracted.
+        QString destination;
+    };
+    struct ExtractionState;
+    class ExtractTask;
+
+    /**
+     * Creates the directories for the entry at @p planIndex of @p plan and handles
+     * an existing destination file, asking the user if needed.
+     */
+    bool prepareEntry(QVector<ExtractedEntry> &plan, int planIndex, const QString &destDir, bool preservePaths, bool removeRootNode);
+
+    /**
+     * Asks for the password if one of @p entries is encrypted and the password is not known.
+     */
+    bool queryPassword(zip_t *archive, const QVector<ExtractedEntry> &entries);
+
+    /**
+     * Extracts the data of @p entries from several threads.
+     */
+    bool extractEntries(zip_t *archive, const QVector<ExtractedEntry> &entries);
+
+    /**
+     * Runs the threads reading the entries of @p state and waits for them,
+     * emitting the progress.
+     */
+    void runExtractTasks(zip_t *archive, ExtractionState &state);
+
+    /**
+     * Reads the data of @p entry, writing it to its destination unless
+     * @p isTested is true.
+     */
+    static bool extractEntryData(zip_t *archive, const ExtractedEntry &entry, bool isTested, QByteArray &buffer, const QAtomicInt &cancelled, QString *errorMessage);
+    /**
+     * Adds @p entry to the archive. The data of files is read from @p source, or from the
+     * file itself if @p source is nullptr.
+     */
+    bool writeEntry(zip_t *archive, const QString &entry, const Archive::Entry* destination, const CompressionOptions& options, bool isDir, zip_source_t *source, QVector<qlonglong> &addedIndices);
     bool emitEntryForIndex(zip_t *archive, qlonglong index);
+
+    /**
+     * Emits the entries at @p indices of the archive, which have just been written.
+     */
+    bool emitAddedEntries(QVector<qlonglong> indices);
     void progressEmitted(double pct);
 
     QVector<Archive::Entry*> m_emittedEntries;
     bool m_overwriteAll;
     bool m_skipAll;
-    bool m_listAfterAdd;
+    // The directories created during the current extraction.
+    QSet<QString> m_createdDirectories;
+    // The files planned to be extracted so far, with the index of their entry in the plan.
+    QHash<QString, int> m_plannedDestinations;
 };
 
 #endif // LIBZIPPLUGIN_H
@@ -0,0 +1,404 @@
+/*
+ * Copyright (c) 2026 The Ark developers <kde-utils-devel@kde.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES ( INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION ) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * ( INCLUDING NEGLIGENCE OR OTHERWISE ) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "parallelzipcompressor.h"
+#include "ark_debug.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QTemporaryFile>
+
+#include <zlib.h>
+
+#include <cstring>
+
+// The size of the buffers used to read and compress the files.
+static const int bufferSize = 1024 * 1024;
+// The largest compressed data kept in memory for a file.
+static const int maxInMemorySize = 1024 * 1024;
+// The largest total size of the spill files.
+static const qint64 maxSpilledSize = Q_INT64_C(1024) * 1024 * 1024;
+
+class ParallelZipCompressor::CompressTask : public QRunnable
+{
+public:
+    explicit CompressTask(ParallelZipCompressor *compressor)
+        : m_compressor(compressor)
+    {
+    }
+
+    void run() override
+    {
+        m_compressor->compressFiles();
+    }
+
+private:
+    ParallelZipCompressor *m_compressor;
+};
+
+// The state of a source returned by source().
+struct ParallelZipCompressor::Source
+{
+    ParallelZipCompressor *compressor;
+    int index;
+    CompressedFile file;
+    // The file read by libzip when it is left to libzip.
+    QFile *input;
+    qint64 position;
+    zip_error_t error;
+};
+
+ParallelZipCompressor::ParallelZipCompressor(const QStringList &files, int threadCount, const QString &tempDirectory)
+    : m_files(files)
+    , m_tempDirectory(tempDirectory)
+    , m_compressedFiles(files.size())
+    , m_requestedFiles(0)
+    , m_spilledSize(0)
+{
+    threadCount = qBound(1, threadCount, qMax(1, files.size()));
+    m_threadPool.setMaxThreadCount(threadCount);
+    m_maxQueuedFiles = 2 * threadCount;
+
+    qCDebug(ARK) << "Compressing" << files.size() << "files with" << threadCount << "threads";
+
+    for (int i = 0; i < threadCount; i++) {
+        m_threadPool.start(new CompressTask(this));
+    }
+}
+
+ParallelZipCompressor::~ParallelZipCompressor()
+{
+    m_cancelled.storeRelease(1);
+    {
+        QMutexLocker locker(&m_mutex);
+        m_fileRequested.wakeAll();
+    }
+    m_threadPool.waitForDone();
+}
+
+zip_source_t *ParallelZipCompressor::source(zip_t *archive, int index)
+{
+    auto source = new Source;
+    source->compressor = this;
+    source->index = index;
+    source->input = nullptr;
+    source->position = 0;
+    zip_error_init(&source->error);
+
+    zip_source_t *zipSource = zip_source_function(archive, sourceCallback, source);
+    if (!zipSource) {
+        zip_error_fini(&source->error);
+        delete source;
+    }
+    return zipSource;
+}
+
+zip_int64_t ParallelZipCompressor::sourceCallback(void *userdata, void *data, zip_uint64_t length, zip_source_cmd_t command)
+{
+    auto source = static_cast<Source*>(userdata);
+
+    switch (command) {
+    case ZIP_SOURCE_OPEN:
+        // The compressor drops its data once written, so the source keeps its own copy.
+        if (!source->file.isCompressed) {
+            source->file = source->compressor->waitForFile(source->index);
+        }
+        if (source->file.failed) {
+            zip_error_set(&source->error, ZIP_ER_READ, 0);
+            return -1;
+        }
+        if (source->file.isLeftToLibzip) {
+            delete source->input;
+            source->input = new QFile(source->compressor->m_files.at(source->index));
+            if (!source->input->open(QIODevice::ReadOnly)) {
+                zip_error_set(&source->error, ZIP_ER_OPEN, 0);
+                return -1;
+            }
+        } else if (source->file.spillFile && !source->file.spillFile->seek(0)) {
+            zip_error_set(&source->error, ZIP_ER_SEEK, 0);
+            return -1;
+        }
+        source->position = 0;
+        return 0;
+
+    case ZIP_SOURCE_READ: {
+        if (source->input) {
+            const qint64 readSize = source->input->read(static_cast<char*>(data), length);
+            if (readSize < 0) {
+                zip_error_set(&source->error, ZIP_ER_READ, 0);
+                return -1;
+            }
+            return readSize;
+        }
+
+        const qint64 size = qMin<qint64>(length, source->file.compressedSize - source->position);
+        if (size <= 0) {
+            return 0;
+        }
+        if (!source->file.spillFile) {
+            memcpy(data, source->file.data.constData() + source->position, size);
+            source->position += size;
+            return size;
+        }
+        const qint64 readSize = source->file.spillFile->read(static_cast<char*>(data), size);
+        if (readSize < 0) {
+            zip_error_set(&source->error, ZIP_ER_READ, 0);
+            return -1;
+        }
+        source->position += readSize;
+        return readSize;
+    }
+
+    case ZIP_SOURCE_CLOSE:
+        delete source->input;
+        source->input = nullptr;
+        return 0;
+
+    case ZIP_SOURCE_STAT: {
+        if (!source->file.isCompressed) {
+            source->file = source->compressor->waitForFile(source->index);
+        }
+        if (source->file.failed) {
+            zip_error_set(&source->error, ZIP_ER_READ, 0);
+            return -1;
+        }
+
+        auto st = static_cast<zip_stat_t*>(data);
+        zip_stat_init(st);
+        st->mtime = source->file.mtime;
+        st->valid |= ZIP_STAT_MTIME;
+        if (source->file.isLeftToLibzip) {
+            // Without a compression method, libzip compresses the data itself.
+            st->size = QFileInfo(source->compressor->m_files.at(source->index)).size();
+            st->valid |= ZIP_STAT_SIZE;
+            return sizeof(zip_stat_t);
+        }
+
+        // The data is already deflated, so zip_close() does not compress it again.
+        st->size = source->file.size;
+        st->comp_size = source->file.compressedSize;
+        st->comp_method = ZIP_CM_DEFLATE;
+        st->crc = source->file.crc;
+        st->valid |= ZIP_STAT_SIZE | ZIP_STAT_COMP_SIZE | ZIP_STAT_COMP_METHOD | ZIP_STAT_CRC;
+        return sizeof(zip_stat_t);
+    }
+
+    case ZIP_SOURCE_ERROR:
+        return zip_error_to_data(&source->error, data, length);
+
+    case ZIP_SOURCE_FREE:
+        // The spill file is removed with the last copy of the file.
+        source->compressor->releaseFile(source->index);
+        delete source->input;
+        zip_error_fini(&source->error);
+        delete source;
+        return 0;
+
+    case ZIP_SOURCE_SUPPORTS:
+        return zip_source_make_command_bitmap(ZIP_SOURCE_OPEN, ZIP_SOURCE_READ, ZIP_SOURCE_CLOSE, ZIP_SOURCE_STAT,
+                                              ZIP_SOURCE_ERROR, ZIP_SOURCE_FREE, ZIP_SOURCE_SUPPORTS, -1);
+
+    default:
+        zip_error_set(&source->error, ZIP_ER_OPNOTSUPP, 0);
+        return -1;
+    }
+}
+
+void ParallelZipCompressor::compressFiles()
+{
+    forever {
+        if (m_cancelled.loadAcquire()) {
+            return;
+        }
+
+        const int index = m_nextFile.fetchAndAddOrdered(1);
+        if (index >= m_files.size()) {
+            return;
+        }
+
+        // Wait for libzip to catch up, so that the compressed data does not pile up.
+        {
+            QMutexLocker locker(&m_mutex);
+            while (index >= m_requestedFiles + m_maxQueuedFiles && !m_cancelled.loadAcquire()) {
+                m_fileRequested.wait(&m_mutex);
+            }
+        }
+        if (m_cancelled.loadAcquire()) {
+            return;
+        }
+
+        CompressedFile compressedFile;
+        if (!compressFile(m_files.at(index), &compressedFile)) {
+            dropData(&compressedFile);
+            compressedFile.failed = !compressedFile.isLeftToLibzip;
+        }
+        compressedFile.isCompressed = true;
+
+        QMutexLocker locker(&m_mutex);
+        m_compressedFiles[index] = compressedFile;
+        m_fileCompressed.wakeAll();
+    }
+}
+
+bool ParallelZipCompressor::compressFile(const QString &path, CompressedFile *compressedFile)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCCritical(ARK) << "Failed to open" << path << ":" << file.errorString();
+        return false;
+    }
+    compressedFile->mtime = QFileInfo(file).lastModified().toTime_t();
+
+    // A raw deflate stream, at the level libzip uses by default.
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    if (deflateInit2(&stream, Z_BEST_COMPRESSION, Z_DEFLATED, -MAX_WBITS, MAX_MEM_LEVEL, Z_DEFAULT_STRATEGY) != Z_OK) {
+        qCCritical(ARK) << "Failed to initialize the deflate stream";
+        return false;
+    }
+
+    QByteArray input(bufferSize, Qt::Uninitialized);
+    QByteArray output(bufferSize, Qt::Uninitialized);
+    uLong crc = crc32(0L, Z_NULL, 0);
+    bool isSuccessful = true;
+
+    int flush;
+    do {
+        const qint64 readSize = file.read(input.data(), input.size());
+        if (readSize < 0 || m_cancelled.loadAcquire()) {
+            isSuccessful = false;
+            break;
+        }
+        crc = crc32(crc, reinterpret_cast<const Bytef*>(input.constData()), readSize);
+        compressedFile->size += readSize;
+
+        flush = file.atEnd() ? Z_FINISH : Z_NO_FLUSH;
+        stream.next_in = reinterpret_cast<Bytef*>(input.data());
+        stream.avail_in = readSize;
+        do {
+            stream.next_out = reinterpret_cast<Bytef*>(output.data());
+            stream.avail_out = output.size();
+            deflate(&stream, flush);
+            const qint64 outputSize = output.size() - stream.avail_out;
+            if (!writeCompressedData(output.constData(), outputSize, compressedFile)) {
+                isSuccessful = false;
+                break;
+            }
+        } while (stream.avail_out == 0);
+    } while (isSuccessful && flush != Z_FINISH);
+
+    deflateEnd(&stream);
+
+    // The data is read back from the start of the spill file.
+    if (isSuccessful && compressedFile->spillFile && !compressedFile->spillFile->flush()) {
+        isSuccessful = false;
+    }
+
+    compressedFile->crc = crc;
+    return isSuccessful;
+}
+
+bool ParallelZipCompressor::writeCompressedData(const char *data, qint64 size, CompressedFile *compressedFile)
+{
+    if (!compressedFile->spillFile && compressedFile->compressedSize + size <= maxInMemorySize) {
+        compressedFile->data.append(data, size);
+        compressedFile->compressedSize += size;
+        return true;
+    }
+
+    // Make room for the data in the spill files, or leave the file to libzip.
+    {
+        const qint64 spilledSize = compressedFile->spillFile ? size : compressedFile->compressedSize + size;
+        QMutexLocker locker(&m_mutex);
+        if (m_spilledSize + spilledSize > maxSpilledSize) {
+            qCDebug(ARK) << "No room left in the spill files, leaving the file to libzip";
+            compressedFile->isLeftToLibzip = true;
+            return false;
+        }
+        m_spilledSize += spilledSize;
+    }
+
+    if (!compressedFile->spillFile) {
+        // Move the data compressed so far to a new spill file.
+        compressedFile->spillFile.reset(new QTemporaryFile(QDir(m_tempDirectory).filePath(QStringLiteral(".ark-zip-XXXXXX"))));
+        if (!compressedFile->spillFile->open()) {
+            qCWarning(ARK) << "Failed to create a temporary file in" << m_tempDirectory << ", leaving the file to libzip";
+            compressedFile->isLeftToLibzip = true;
+            compressedFile->compressedSize += size;
+            return false;
+        }
+        if (compressedFile->spillFile->write(compressedFile->data) != compressedFile->data.size()) {
+            qCCritical(ARK) << "Failed to write compressed data:" << compressedFile->spillFile->errorString();
+            compressedFile->compressedSize += size;
+            return false;
+        }
+        compressedFile->data.clear();
+    }
+
+    compressedFile->compressedSize += size;
+    if (compressedFile->spillFile->write(data, size) != size) {
+        qCCritical(ARK) << "Failed to write compressed data:" << compressedFile->spillFile->errorString();
+        return false;
+    }
+    return true;
+}
+
+void ParallelZipCompressor::dropData(CompressedFile *compressedFile)
+{
+    compressedFile->data.clear();
+    if (compressedFile->spillFile) {
+        compressedFile->spillFile.reset();
+        QMutexLocker locker(&m_mutex);
+        m_spilledSize -= compressedFile->compressedSize;
+    }
+}
+
+ParallelZipCompressor::CompressedFile ParallelZipCompressor::waitForFile(int index)
+{
+    QMutexLocker locker(&m_mutex);
+    if (index >= m_requestedFiles) {
+        m_requestedFiles = index + 1;
+        m_fileRequested.wakeAll();
+    }
+    while (!m_compressedFiles.at(index).isCompressed) {
+        m_fileCompressed.wait(&m_mutex);
+    }
+    return m_compressedFiles.at(index);
+}
+
+void ParallelZipCompressor::releaseFile(int index)
+{
+    QMutexLocker locker(&m_mutex);
+    CompressedFile &compressedFile = m_compressedFiles[index];
+    compressedFile.data.clear();
+    if (compressedFile.spillFile) {
+        compressedFile.spillFile.reset();
+        m_spilledSize -= compressedFile.compressedSize;
+    }
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2026 The Ark developers <kde-utils-devel@kde.org>
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES ( INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION ) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * ( INCLUDING NEGLIGENCE OR OTHERWISE ) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PARALLELZIPCOMPRESSOR_H
+#define PARALLELZIPCOMPRESSOR_H
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVector>
+#include <QWaitCondition>
+
+#include <zip.h>
+
+class QTemporaryFile;
+
+/**
+ * Deflates files from a pool of threads, for adding them to a zip archive.
+ *
+ * Each thread compresses whole files into raw deflate streams. Small streams
+ * are kept in memory, larger ones are spilled to a temporary file of their
+ * own, which is removed once libzip has written it. The sources returned by
+ * source() give libzip the already compressed data, which zip_close() writes
+ * as is. The archive is thus identical to the one libzip would write, except
+ * that the entries are compressed in parallel.
+ *
+ * The total size of the spill files is bounded. The files which do not fit
+ * are left to libzip, which compresses them itself in zip_close().
+ *
+ * The files are compressed in the order of @p files, which should be the
+ * order in which they are added to the archive. The threads compress at most
+ * twice as many files as there are threads ahead of the last file libzip
+ * asked for, so they do not run ahead of zip_close() with large archives.
+ */
+class ParallelZipCompressor
+{
+public:
+    /**
+     * Starts compressing @p files.
+     *
+     * @param tempDirectory The directory of the spill files, usually the one
+     * of the archive.
+     */
+    ParallelZipCompressor(const QStringList &files, int threadCount, const QString &tempDirectory);
+
+    /**
+     * Stops compressing and removes the spill files.
+     */
+    ~ParallelZipCompressor();
+
+    /**
+     * @return A source for the compressed data of the file at @p index, which
+     * waits for the file to be compressed when libzip reads it.
+     */
+    zip_source_t *source(zip_t *archive, int index);
+
+private:
+    class CompressTask;
+    struct Source;
+
+    struct CompressedFile
+    {
+        bool isCompressed = false;
+        bool failed = false;
+        // Whether the file is left to libzip, as there was no room to spill it.
+        bool isLeftToLibzip = false;
+        // The compressed data, unless it has been spilled.
+        QByteArray data;
+        QSharedPointer<QTemporaryFile> spillFile;
+        qint64 size = 0;
+        qint64 compressedSize = 0;
+        quint32 crc = 0;
+        time_t mtime = 0;
+    };
+
+    static zip_int64_t sourceCallback(void *userdata, void *data, zip_uint64_t length, zip_source_cmd_t command);
+
+    void compressFiles();
+    bool compressFile(const QString &path, CompressedFile *compressedFile);
+
+    /**
+     * Appends @p size bytes of compressed data to @p compressedFile, spilling
+     * it once it gets too large to be kept in memory.
+     *
+     * @return False if the data could not be written, or if there is no room
+     * left to spill it, in which case the file is left to libzip.
+     */
+    bool writeCompressedData(const char *data, qint64 size, CompressedFile *compressedFile);
+
+    /**
+     * Removes the spill file of @p compressedFile, if any, and frees its data.
+     */
+    void dropData(CompressedFile *compressedFile);
+
+    /**
+     * Waits until the file at @p index has been compressed, and lets the
+     * threads compress the files following it.
+     */
+    CompressedFile waitForFile(int index);
+
+    /**
+     * Drops the compressed data of the file at @p index, which libzip has written.
+     */
+    void releaseFile(int index);
+
+    const QStringList m_files;
+    const QString m_tempDirectory;
+
+    QThreadPool m_threadPool;
+    QMutex m_mutex;
+    QWaitCondition m_fileCompressed;
+    QWaitCondition m_fileRequested;
+    QVector<CompressedFile> m_compressedFiles;
+    // The number of files libzip has asked for so far.
+    int m_requestedFiles;
+    int m_maxQueuedFiles;
+    // The total size of the spill files.
+    qint64 m_spilledSize;
+    QAtomicInt m_nextFile;
+    QAtomicInt m_cancelled;
+};
+
+#endif // PARALLELZIPCOMPRESSOR_H